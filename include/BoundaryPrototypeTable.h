@@ -0,0 +1,40 @@
+#ifndef BOUNDARYPROTOTYPETABLE_H
+#define BOUNDARYPROTOTYPETABLE_H
+
+#include <vector>
+#include <unordered_map>
+#include "reluka.h"
+#include "pwl2limodsat.h"
+
+namespace reluka
+{
+// Hash-consed collection of boundary prototypes. Rows describing the same
+// hyperplane up to a nonzero scale are stored once: they are compared after
+// dividing by their largest absolute coefficient and orienting the first
+// nonzero coefficient to be positive, within a tolerance.
+class BoundaryPrototypeTable
+{
+    public:
+        BoundaryPrototypeTable(double tolerance);
+
+        // Index of the stored prototype, with LeqZero when its orientation
+        // is the opposite of boundProt, so that the half-spaces swap
+        pwl2limodsat::Boundary intern(const pwl2limodsat::BoundaryPrototype& boundProt);
+
+        const pwl2limodsat::BoundaryPrototypeCollection& getBoundProtData() const { return boundProtData; }
+        size_t size() const { return boundProtData.size(); }
+
+    private:
+        double tol;
+        pwl2limodsat::BoundaryPrototypeCollection boundProtData;
+        std::vector<pwl2limodsat::BoundaryPrototype> canonicalData;
+        std::vector<char> canonicalFlipped;
+        std::unordered_map<size_t, std::vector<pwl2limodsat::BoundProtIndex>> buckets;
+
+        bool canonicalize(const pwl2limodsat::BoundaryPrototype& boundProt,
+                          pwl2limodsat::BoundaryPrototype& canonical);
+        size_t hash(const pwl2limodsat::BoundaryPrototype& canonical);
+};
+}
+
+#endif // BOUNDARYPROTOTYPETABLE_H
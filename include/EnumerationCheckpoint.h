@@ -0,0 +1,61 @@
+#ifndef ENUMERATIONCHECKPOINT_H
+#define ENUMERATIONCHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <fstream>
+#include "reluka.h"
+#include "pwl2limodsat.h"
+#include "EnumerationScheduler.h"
+#include "RegionStore.h"
+#include "InputDomain.h"
+
+namespace reluka
+{
+// State of an interrupted region enumeration: the regions already found,
+// with the prototypes they use, and the tasks covering the rest of the
+// search. The shape of the network, a hash of its weights and biases, the
+// output indexes, the input domain and the -exact setting are kept too, so a
+// checkpoint is not resumed on another enumeration.
+class EnumerationCheckpoint
+{
+    public:
+        EnumerationCheckpoint(const NeuralNetworkData& neuralNetwork,
+                              const std::vector<unsigned>& nnOutputIndexes,
+                              const InputDomain& inputDomain,
+                              bool exactDecisions);
+
+        void addRegions(const RegionStore& regions, const pwl2limodsat::BoundaryPrototypeCollection& regionsBoundProtData);
+        void addTask(const EnumerationTask& task) { tasks.push_back(task); }
+
+        const pwl2limodsat::BoundaryPrototypeCollection& getBoundProtData() { return boundProtData; }
+        const pwl2limodsat::PiecewiseLinearFunctionData& getPwlData(size_t outIdx) { return pwlData.at(outIdx); }
+        std::vector<EnumerationTask>& getTasks() { return tasks; }
+
+        void write(std::string fileName);
+        void read(std::string fileName);
+
+    private:
+        std::vector<size_t> networkShape;
+        uint64_t networkHash;
+        bool exact;
+        std::vector<unsigned> outputIndexes;
+        InputDomain domain;
+
+        pwl2limodsat::BoundaryPrototypeCollection boundProtData;
+        std::map<pwl2limodsat::BoundaryPrototype, pwl2limodsat::BoundProtIndex> boundProtIdx;
+        std::vector<pwl2limodsat::PiecewiseLinearFunctionData> pwlData;
+        std::vector<EnumerationTask> tasks;
+
+        void writeBoundProtData(std::ofstream& checkpointFile, const pwl2limodsat::BoundaryPrototypeCollection& data);
+        void writeBoundary(std::ofstream& checkpointFile, const pwl2limodsat::Boundary& bound);
+        void readBoundProtData(std::ifstream& checkpointFile, pwl2limodsat::BoundaryPrototypeCollection& data);
+        pwl2limodsat::BoundarySymbol readSymbol(std::ifstream& checkpointFile);
+        size_t readSize(std::ifstream& checkpointFile);
+        void readKeyword(std::ifstream& checkpointFile, std::string keyword);
+};
+}
+
+#endif // ENUMERATIONCHECKPOINT_H
@@ -0,0 +1,69 @@
+#ifndef ENUMERATIONSCHEDULER_H
+#define ENUMERATIONSCHEDULER_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "reluka.h"
+#include "pwl2limodsat.h"
+
+namespace reluka
+{
+// A subtree of the region enumeration: the affine values reaching layer
+// layerNum together with the boundaries of the region they hold on.
+// Boundary indexes refer to the task's own prototype collection, so a task
+// may be run by any worker. A task split off within a layer fixes the signs
+// of the first neurons of layerNum in prefix and only enumerates the
+// patterns starting with them. A task suspended for a checkpoint also keeps
+// the activation pattern it was exploring at each layer from layerNum on,
+// and resumes the search from them.
+struct EnumerationTask
+{
+    size_t layerNum = 0;
+    pwl2limodsat::BoundaryPrototypeCollection inputValues;
+    pwl2limodsat::BoundaryPrototypeCollection boundProtData;
+    pwl2limodsat::BoundaryCollection boundData;
+    std::vector<pwl2limodsat::BoundarySymbol> prefix;
+    std::vector<std::vector<pwl2limodsat::BoundarySymbol>> resumeIterations;
+};
+
+// Work-stealing scheduler: every worker owns a deque, takes its own tasks
+// from the back and steals from the front of the other deques when idle.
+class EnumerationScheduler
+{
+    public:
+        EnumerationScheduler(unsigned workersNum);
+        unsigned getWorkersNum() { return queues.size(); }
+        bool hasHungryWorkers() { return ( idleWorkers > 0 ) && ( queuedTasks == 0 ); }
+
+        void push(unsigned workerId, EnumerationTask&& task);
+        bool pop(unsigned workerId, EnumerationTask& task);
+        void taskDone();
+        void abort();
+        void suspend();
+        void drain(std::vector<EnumerationTask>& tasks);
+
+    private:
+        struct WorkerQueue
+        {
+            std::mutex queueMutex;
+            std::deque<EnumerationTask> tasks;
+        };
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+        std::mutex idleMutex;
+        std::condition_variable idleCondition;
+        std::atomic<unsigned> idleWorkers{0};
+        std::atomic<size_t> queuedTasks{0};
+        std::atomic<size_t> pendingTasks{0};
+        std::atomic<bool> aborted{false};
+        std::atomic<bool> suspended{false};
+
+        bool tryPop(unsigned workerId, EnumerationTask& task);
+};
+}
+
+#endif // ENUMERATIONSCHEDULER_H
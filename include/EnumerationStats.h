@@ -0,0 +1,60 @@
+#ifndef ENUMERATIONSTATS_H
+#define ENUMERATIONSTATS_H
+
+#include <vector>
+#include <fstream>
+#include <string>
+
+namespace reluka
+{
+// Counters of one layer of the region enumeration. Position calls classify
+// a neuron against the input box, feasibility checks decide whether a region
+// is empty; both only solve an LP when cheaper tests are inconclusive.
+// With exact decisions, position calls near the tolerance are decided in
+// rational arithmetic and feasibility checks whose floating point answer is
+// not confirmed exactly solve a rational LP.
+// Learned conflicts are the infeasible boundary subsets stored when an LP
+// finds a region empty, and conflict rejections the feasibility checks
+// answered by one of them without an LP.
+// Regions are the activation patterns explored at a hidden layer and the
+// pieces written at the output layer.
+struct LayerStats
+{
+    size_t positionCalls = 0;
+    size_t positionLps = 0;
+    double positionLpSeconds = 0;
+    size_t positionExact = 0;
+    size_t feasibilityChecks = 0;
+    size_t feasibleChecks = 0;
+    size_t infeasibleChecks = 0;
+    size_t feasibilityLps = 0;
+    double feasibilityLpSeconds = 0;
+    size_t feasibilityExactLps = 0;
+    size_t conflictsLearned = 0;
+    size_t conflictRejections = 0;
+    size_t regions = 0;
+};
+
+// Statistics gathered by one enumeration worker, or summed over all of them
+class EnumerationStats
+{
+    public:
+        EnumerationStats(size_t layersNum = 0) : layers(layersNum) {}
+
+        LayerStats& layer(size_t layerNum) { return layers[layerNum]; }
+        void taskRun() { tasksNum++; }
+        void updatePeakBoundProtData(size_t boundProtDataSize);
+        void updatePeakConflicts(size_t conflictsNum);
+
+        void add(const EnumerationStats& other);
+        void writeJson(std::ofstream& statsFile, const std::string& indent) const;
+
+    private:
+        std::vector<LayerStats> layers;
+        size_t tasksNum = 0;
+        size_t peakBoundProtData = 0;
+        size_t peakConflicts = 0;
+};
+}
+
+#endif // ENUMERATIONSTATS_H
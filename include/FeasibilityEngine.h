@@ -0,0 +1,105 @@
+#ifndef FEASIBILITYENGINE_H
+#define FEASIBILITYENGINE_H
+
+#include <vector>
+#include <map>
+#include "soplex.h"
+#include "reluka.h"
+#include "pwl2limodsat.h"
+#include "InputDomain.h"
+
+namespace reluka
+{
+// Keeps a single SoPlex instance alive along a depth-first search path over
+// an input domain, whose constraints are the first, permanent rows.
+// Boundaries are pushed and popped as a stack, so each feasibility check
+// only adds or removes one row and warm-starts from the previous basis.
+// A point of every region proven feasible is kept per depth, so a boundary
+// it satisfies with a margin is accepted without solving an LP. Infeasible
+// subsets of boundaries found through Farkas certificates are remembered and
+// reject any later region containing them, also without solving an LP.
+// The store holds at most a given number of conflicts; those over the
+// prototypes of a finished layer are discarded, as they cannot match again.
+// With exact decisions, every floating point answer is checked in rational
+// arithmetic: a witness must satisfy the rows exactly and a Farkas
+// certificate must prove infeasibility exactly. Only when the check fails is
+// the region solved again by a rational LP.
+class FeasibilityEngine
+{
+    public:
+        FeasibilityEngine(const InputDomain& inputDomain, bool exactDecisions = false);
+        FeasibilityEngine(const FeasibilityEngine&) = delete;
+        FeasibilityEngine& operator=(const FeasibilityEngine&) = delete;
+        ~FeasibilityEngine();
+
+        void pushBoundary(const pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
+                          const pwl2limodsat::Boundary& bound);
+        void popBoundary();
+        bool isFeasible();
+        size_t getDepth() { return knownFeasibility.size() - 1; }
+        size_t getLpsNum() { return lpsNum; }
+        double getLpSeconds() { return lpSeconds; }
+        size_t getExactLpsNum() { return exactLpsNum; }
+        size_t getLearnedConflictsNum() { return learnedConflictsNum; }
+        size_t getConflictHitsNum() { return conflictHitsNum; }
+        size_t getLiveConflictsNum() { return conflicts.size() - deadConflictsNum; }
+        void setMaxConflicts(size_t maxConflictsNum) { maxConflicts = maxConflictsNum; }
+        void discardConflicts(pwl2limodsat::BoundProtIndex firstDiscardedIdx);
+        void clear();
+
+    private:
+        soplex::SoPlex *sop;
+        size_t inputDim;
+        InputDomain domain;
+        bool exact;
+
+        // The witness of depth d is inputDim values from d * inputDim on;
+        // the buffers only grow, so the search reuses them as it goes
+        enum Feasibility { Unknown, Infeasible, Feasible };
+        std::vector<Feasibility> knownFeasibility;
+        std::vector<double> witnesses;
+        std::vector<char> witnessed;
+
+        // Rows refer to their prototypes by collection and index; the same
+        // boundaries are also kept sorted, so conflicts are looked up in them
+        pwl2limodsat::BoundaryCollection rowBounds;
+        std::vector<const pwl2limodsat::BoundaryPrototypeCollection*> rowProtData;
+        pwl2limodsat::BoundaryCollection activeBounds;
+        std::vector<pwl2limodsat::BoundaryCollection> conflicts;
+        std::map<pwl2limodsat::Boundary, std::vector<size_t>> conflictIndex;
+        size_t deadConflictsNum = 0;
+        size_t maxConflicts;
+
+        // Buffers of a single row or LP, reused by every one of them
+        soplex::DSVector rowVector;
+        soplex::LPRow lpRow;
+        soplex::DVector primal;
+        soplex::DVector farkas;
+        std::vector<double> floatCombination;
+        std::vector<soplex::Rational> exactCombination;
+        pwl2limodsat::BoundaryCollection conflict;
+
+        size_t lpsNum = 0;
+        double lpSeconds = 0;
+        size_t exactLpsNum = 0;
+        size_t learnedConflictsNum = 0;
+        size_t conflictHitsNum = 0;
+
+        void initialize();
+        void addRow(const pwl2limodsat::BoundaryPrototype& boundProt, pwl2limodsat::BoundarySymbol boundSymbol);
+        bool solve();
+        bool exactSolve();
+        double *witness(size_t depth) { return witnesses.data() + depth * inputDim; }
+        const pwl2limodsat::BoundaryPrototype& rowPrototype(size_t i) const { return (*rowProtData[i])[rowBounds[i].first]; }
+        bool isActive(const pwl2limodsat::Boundary& bound) const;
+        bool satisfies(const double *point,
+                       const pwl2limodsat::BoundaryPrototype& boundProt,
+                       pwl2limodsat::BoundarySymbol boundSymbol);
+        bool satisfiesRows(const double *point);
+        bool hasKnownConflict();
+        template<class T> bool farkasProof(std::vector<T>& combination, const T& tolerance);
+        void learnConflict();
+};
+}
+
+#endif // FEASIBILITYENGINE_H
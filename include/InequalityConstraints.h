@@ -22,6 +22,8 @@ class InequalityConstraints
         std::map<unsigned,std::pair<double,double>> getInputLimits();
         std::vector<unsigned> getNnOutputIndexes();
         void printLiproperty(NeuralNetworkModSat *nnms);
+        void printLipropertyBinary(NeuralNetworkModSat *nnms, bool compression);
+        void printLipropertySmt(NeuralNetworkModSat *nnms);
 
     protected:
 
@@ -0,0 +1,45 @@
+#ifndef INPUTDOMAIN_H
+#define INPUTDOMAIN_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include "reluka.h"
+#include "pwl2limodsat.h"
+
+namespace reluka
+{
+// Part of the input space whose regions are enumerated: a box within the
+// unit cube, optionally cut by linear constraints c + a.x >= 0 or <= 0.
+// Inputs are numbered from 1, as in the prototypes and in getInputLimits.
+class InputDomain
+{
+    public:
+        InputDomain(size_t inputDimension = 0);
+
+        void setLimits(unsigned inputNum, double inputMin, double inputMax);
+        void setLimits(const std::map<unsigned,std::pair<double,double>>& inputLimits);
+        void addConstraint(const pwl2limodsat::BoundaryPrototype& constraint, pwl2limodsat::BoundarySymbol symbol);
+        void readLimits(std::string domainFileName);
+
+        size_t getDimension() const { return lower.size(); }
+        double getLower(size_t i) const { return lower[i]; }
+        double getUpper(size_t i) const { return upper[i]; }
+        std::vector<double> getCentre() const;
+        const pwl2limodsat::BoundaryPrototypeCollection& getConstraintProts() const { return constraintProts; }
+        const pwl2limodsat::BoundaryCollection& getConstraints() const { return constraints; }
+
+        // Extrema of the linear part of a prototype over the box
+        void intervalBounds(const pwl2limodsat::BoundaryPrototype& boundProt, double& minValue, double& maxValue) const;
+
+        bool operator==(const InputDomain& other) const;
+
+    private:
+        std::vector<double> lower;
+        std::vector<double> upper;
+        pwl2limodsat::BoundaryPrototypeCollection constraintProts;
+        pwl2limodsat::BoundaryCollection constraints;
+};
+}
+
+#endif // INPUTDOMAIN_H
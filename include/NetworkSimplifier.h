@@ -0,0 +1,54 @@
+#ifndef NETWORKSIMPLIFIER_H
+#define NETWORKSIMPLIFIER_H
+
+#include <vector>
+#include "reluka.h"
+#include "InputDomain.h"
+
+namespace reluka
+{
+// Shrinks a network without changing the function it computes over the box
+// of an input domain, using interval bounds of every hidden neuron: neurons
+// never active are dropped, neurons computing a constant are folded into the
+// biases of the next layer, equal neurons of a layer are merged and a hidden
+// layer whose neurons are all active is composed with the next one. Folding,
+// merging and composing are skipped where the resulting weights and biases
+// would be rounded to NodeCoefficient. Output neurons and their order are
+// kept, so output indexes remain valid.
+class NetworkSimplifier
+{
+    public:
+        NetworkSimplifier(const NeuralNetworkData& inputNeuralNetwork);
+        NetworkSimplifier(const NeuralNetworkData& inputNeuralNetwork, const InputDomain& inputDomain);
+
+        const NeuralNetworkData& getNeuralNetwork();
+        size_t getDeadNeuronsNum() { return deadNeuronsNum; }
+        size_t getConstantNeuronsNum() { return constantNeuronsNum; }
+        size_t getMergedNeuronsNum() { return mergedNeuronsNum; }
+        size_t getComposedLayersNum() { return composedLayersNum; }
+
+    private:
+        NeuralNetworkData neuralNetwork;
+        InputDomain domain;
+
+        size_t deadNeuronsNum = 0;
+        size_t constantNeuronsNum = 0;
+        size_t mergedNeuronsNum = 0;
+        size_t composedLayersNum = 0;
+
+        bool simplification = false;
+
+        void neuronBounds(const Node& node,
+                          const std::vector<double>& inputLower,
+                          const std::vector<double>& inputUpper,
+                          double& lower,
+                          double& upper);
+        void removeNeuron(size_t layerNum, size_t neuronIdx);
+        static bool isExactCoefficient(double value);
+        bool composeLayer(size_t layerNum);
+        bool simplifyLayer(size_t layerNum, std::vector<double>& inputLower, std::vector<double>& inputUpper);
+        void simplify();
+};
+}
+
+#endif // NETWORKSIMPLIFIER_H
@@ -3,11 +3,86 @@
 
 #include <vector>
 #include <string>
+#include <chrono>
+#include <atomic>
+#include <future>
 #include "reluka.h"
 #include "pwl2limodsat.h"
+#include "FeasibilityEngine.h"
+#include "EnumerationScheduler.h"
+#include "PwlStreamSink.h"
+#include "RegionStore.h"
+#include "EnumerationStats.h"
+#include "InputDomain.h"
 
 namespace reluka
 {
+// State owned by each thread enumerating regions; merged by pwlInfoMerge
+struct EnumerationWorker
+{
+    EnumerationWorker(unsigned workerId,
+                      size_t layersNum,
+                      const InputDomain& inputDomain,
+                      bool exactDecisions,
+                      size_t outputsNum,
+                      EnumerationScheduler *taskScheduler) :
+        id(workerId),
+        regions(outputsNum),
+        engine(inputDomain, exactDecisions),
+        scheduler(taskScheduler),
+        scratch(layersNum),
+        chunks(outputsNum),
+        resumeIterations(layersNum),
+        stats(layersNum) {}
+
+    // Buffers of one layer of the search, reused by every region reaching it
+    struct LayerScratch
+    {
+        pwl2limodsat::BoundaryPrototypeCollection boundProtData;
+        std::vector<BoundProtPosition> boundProtPositions;
+        std::vector<pwl2limodsat::BoundarySymbol> iteration;
+        std::vector<char> activeNeurons;
+        std::vector<char> cuttingNeurons;
+    };
+
+    unsigned id;
+    pwl2limodsat::BoundaryPrototypeCollection boundProtData;
+    RegionStore regions;
+    FeasibilityEngine engine;
+    EnumerationScheduler *scheduler;
+
+    pwl2limodsat::BoundaryCollection boundStack;
+    std::vector<LayerScratch> scratch;
+    // Linear function and output boundaries of the piece being written
+    pwl2limodsat::RegionalLinearPieceData region;
+
+    // Where each live prototype sits, per output, when streaming
+    struct StreamedPrototype
+    {
+        std::vector<size_t> fileIdx;
+        std::vector<size_t> chunkSlot;
+    };
+    std::vector<StreamedPrototype> streamedProts;
+    std::vector<PwlStreamChunk> chunks;
+
+    // Activation patterns to restart each layer from when resuming a task,
+    // the signs the task fixes at its first layer, and the patterns being
+    // explored when the search was suspended, deepest layer first. A task is
+    // only suspended once it reached a new leaf, so every checkpoint round
+    // makes progress.
+    std::vector<std::vector<pwl2limodsat::BoundarySymbol>> resumeIterations;
+    std::vector<pwl2limodsat::BoundarySymbol> taskPrefix;
+    bool progressed = false;
+    bool suspended = false;
+    std::vector<std::vector<pwl2limodsat::BoundarySymbol>> suspendedIterations;
+    std::vector<EnumerationTask> suspendedTasks;
+
+    // Totals also read by the progress reporter while the worker runs
+    EnumerationStats stats;
+    std::atomic<size_t> piecesNum{0};
+    std::atomic<size_t> lpsNum{0};
+};
+
 class NeuralNetwork
 {
     public:
@@ -29,6 +104,11 @@ class NeuralNetwork
         size_t getInputDimension() { return neuralNetwork.front().at(0).size()-1; }
         size_t getOutputDimension() { return neuralNetwork.back().size(); }
         std::vector<unsigned> getNnOutputIndexes() { return nnOutputIndexes; }
+        const InputDomain& getInputDomain() { return inputDomain; }
+        void setInputDomain(const InputDomain& domain);
+        void setInputLimits(const std::map<unsigned,std::pair<double,double>>& inputLimits);
+        void setExact(bool exactDecisions);
+        void setMaxConflicts(size_t maxConflictsNum) { maxConflicts = maxConflictsNum; }
 
         static pwl2limodsat::LPCoefNonNegative gcd(pwl2limodsat::LPCoefNonNegative a,
                                                    pwl2limodsat::LPCoefNonNegative b);
@@ -36,6 +116,15 @@ class NeuralNetwork
 
         void buildPwlData();
         void printPwlFile(unsigned nnOutputIdx);
+        void streamPwlFiles();
+        void reducePwlData();
+        void coalescePwlData();
+        void setCheckpoint(unsigned intervalSeconds);
+        void resumeCheckpoint() { resuming = true; }
+        std::string getCheckpointFileName() { return checkpointFileName; }
+        void setProgress(unsigned intervalSeconds) { progressInterval = std::chrono::seconds(intervalSeconds); }
+        void printStatsFile();
+        std::string getStatsFileName() { return statsFileName; }
 
     private:
         std::vector<std::string> pwlFileName;
@@ -43,59 +132,107 @@ class NeuralNetwork
         ProcessingMode processingMode;
 
         NeuralNetworkData neuralNetwork;
+        std::vector<FlatMatrix> flatWeights;
+        InputDomain inputDomain;
+        // Decisions close to a tolerance are settled in rational arithmetic
+        bool exact = false;
+        // Size of each worker's conflict store, the engine's own when zero
+        size_t maxConflicts = 0;
 
         std::vector<unsigned> nnOutputIndexes;
-        std::vector<pwl2limodsat::PiecewiseLinearFunctionData> pwlData;
+        RegionStore regionStore;
         pwl2limodsat::BoundaryPrototypeCollection boundProtData;
 
         bool pwlTranslation = false;
 
+        // Regions rewritten by post-passes are kept expanded
+        bool pwlExpansion = false;
+        std::vector<pwl2limodsat::PiecewiseLinearFunctionData> expandedPwlData;
+        bool pwlReduction = false;
+        bool pwlCoalescence = false;
+
+        bool streaming = false;
+        std::vector<std::unique_ptr<PwlStreamSink>> pwlSinks;
+
+        std::string checkpointFileName;
+        bool checkpointing = false;
+        bool resuming = false;
+        std::chrono::seconds checkpointInterval{0};
+        std::chrono::steady_clock::time_point checkpointDeadline;
+
+        std::string statsFileName;
+        std::vector<EnumerationStats> workerStats;
+        double enumerationSeconds = 0;
+        std::chrono::seconds progressInterval{0};
+
         void setProcessingMode(ProcessingMode mode) { processingMode = mode; }
         size_t getNnOutputIndexesIdx(unsigned nnOutputIndex);
 
         BoundProtPosition boundProtPosition(const pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
-                                            pwl2limodsat::BoundProtIndex bIdx);
-        bool feasibleBounds(const pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
-                            const pwl2limodsat::BoundaryCollection& boundData);
-        pwl2limodsat::BoundaryPrototypeCollection composeBoundProtData(const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
-                                                                       unsigned layerNum);
+                                            pwl2limodsat::BoundProtIndex bIdx,
+                                            LayerStats& stats);
+        bool checkFeasibility(EnumerationWorker& worker, size_t layerNum);
+        void composeBoundProtData(const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
+                                  const std::vector<char>& activeInputs,
+                                  unsigned layerNum,
+                                  pwl2limodsat::BoundaryPrototypeCollection& newBoundProtData);
         void writeBoundProtData(pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
                                 const pwl2limodsat::BoundaryPrototypeCollection& newBoundProtData);
-        pwl2limodsat::BoundaryPrototypeCollection composeOutputValues(const pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
-                                                                      const std::vector<pwl2limodsat::BoundarySymbol>& iteration,
-                                                                      const std::vector<BoundProtPosition>& boundProtPositions);
-        void writePwlData(pwl2limodsat::PiecewiseLinearFunctionData& pwlData,
-                          const pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
+        void writeActiveNeurons(std::vector<char>& activeNeurons,
+                                const std::vector<pwl2limodsat::BoundarySymbol>& iteration,
+                                const std::vector<BoundProtPosition>& boundProtPositions);
+        void writePwlData(EnumerationWorker& worker,
+                          size_t outIdx,
+                          size_t regionNode,
                           const pwl2limodsat::BoundaryPrototype& inputValues,
-                          const pwl2limodsat::BoundaryCollection& currentBoundData,
                           std::pair<pwl2limodsat::BoundProtIndex,pwl2limodsat::BoundProtIndex> newBoundProtIdx);
-        bool iterate(size_t limitIterationIdx,
-                     std::vector<pwl2limodsat::BoundarySymbol>& iteration,
-                     size_t& currentIterationIdx,
-                     const std::vector<BoundProtPosition>& boundProtPositions,
-                     pwl2limodsat::BoundaryCollection& boundData);
+        void writeRegion(EnumerationWorker& worker, size_t outIdx, size_t regionNode);
+        void flushChunk(EnumerationWorker& worker, size_t outIdx);
+        void truncateBoundProtData(EnumerationWorker& worker, pwl2limodsat::BoundProtIndex newSize);
         bool iterate(std::vector<pwl2limodsat::BoundarySymbol>& iteration,
                      size_t& currentIterationIdx,
+                     size_t firstIterationIdx,
                      const std::vector<BoundProtPosition>& boundProtPositions,
-                     pwl2limodsat::BoundaryCollection& boundData);
+                     pwl2limodsat::BoundaryCollection& boundData,
+                     FeasibilityEngine& engine);
 
-        void net2pwl(pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
-                     std::vector<pwl2limodsat::PiecewiseLinearFunctionData>& pwlData,
+        void net2pwl(EnumerationWorker& worker,
                      const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
-                     const pwl2limodsat::BoundaryCollection& currentBoundData,
-                     size_t layerNum);
-        void net2pwl(const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
-                     const pwl2limodsat::BoundaryCollection& currentBoundData,
+                     const std::vector<char>& activeInputs,
+                     size_t parentNode,
                      size_t layerNum);
+        void splitTask(EnumerationWorker& worker,
+                       const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
+                       const std::vector<char>& activeInputs,
+                       size_t layerNum,
+                       size_t boundsNum,
+                       const std::vector<pwl2limodsat::BoundarySymbol>& iteration,
+                       size_t prefixSize);
+        void runTask(EnumerationWorker& worker, const EnumerationTask& task);
+        void runWorker(EnumerationWorker *worker);
+        void runTasks(const std::vector<std::unique_ptr<EnumerationWorker>>& workers, std::vector<EnumerationTask>& tasks);
+        bool checkpointDue() { return checkpointing && ( std::chrono::steady_clock::now() >= checkpointDeadline ); }
+        void writeCheckpoint(const std::vector<std::unique_ptr<EnumerationWorker>>& workers, const std::vector<EnumerationTask>& tasks);
+        void loadCheckpoint(std::vector<EnumerationTask>& tasks);
+        void reportProgress(const std::vector<std::unique_ptr<EnumerationWorker>>& workers, std::future<void> enumerationDone);
+        void pwlInfoMerge(const std::vector<std::unique_ptr<EnumerationWorker>>& workers);
+        void compactBoundProtData();
 
-        std::pair<std::vector<pwl2limodsat::PiecewiseLinearFunctionData>,
-                  pwl2limodsat::BoundaryPrototypeCollection> partialNet2pwl(unsigned startingPoint,
-                                                                            size_t fixedNodesNum,
-                                                                            const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
-                                                                            const std::vector<BoundProtPosition>& boundProtPositions);
-        void pwlInfoMerge(const std::vector<std::pair<std::vector<pwl2limodsat::PiecewiseLinearFunctionData>,
-                                                      pwl2limodsat::BoundaryPrototypeCollection>>& threadsInfo);
-        void net2pwlMultithreading(const pwl2limodsat::BoundaryPrototypeCollection& inputValues);
+        size_t getPiecesNum(size_t outIdx);
+        void expandPiece(size_t outIdx, size_t pieceIdx, pwl2limodsat::RegionalLinearPieceData& rlpData);
+        void expandPwlData();
+        void renumberBoundProtData();
+        void regionLp(soplex::SoPlex& sop, const pwl2limodsat::BoundaryCollection& boundData);
+        bool boundHolds(soplex::SoPlex& sop, const pwl2limodsat::Boundary& bound);
+        void reduceRegion(pwl2limodsat::RegionalLinearPieceData& rlpData);
+        void partialReduce(pwl2limodsat::PiecewiseLinearFunctionData& pwlData, size_t beginIdx, size_t endIdx);
+        bool coalesceRegions(pwl2limodsat::RegionalLinearPieceData& first,
+                             const pwl2limodsat::RegionalLinearPieceData& second);
+        void partialCoalesce(pwl2limodsat::PiecewiseLinearFunctionData& pwlData,
+                             std::vector<std::vector<size_t>>& groups,
+                             std::vector<char>& removed,
+                             size_t beginIdx,
+                             size_t endIdx);
 
         void net2pwl();
 };
@@ -28,8 +28,13 @@ class NeuralNetworkModSat
         size_t getOutputDimension() { return neuralNetwork.back().size(); }
         void representNNmodsat();
         void printNNmodsatFile(unsigned outIdx);
+        void printNNmodsatBinaryFile(unsigned outIdx, bool compression);
+        void printNNsmtFile(unsigned outIdx);
+        pwl2limodsat::Variable currentVariable() { return vm->currentVariable(); }
         std::map<unsigned,std::pair<double,double>> getOriginalOutputLim();
-        void printNNmodsat(std::ofstream *propertyFile, std::vector<pwl2limodsat::Variable> nnOutputVariables);
+        void printNNmodsat(lukaFormula::FormulaWriter& writer, std::vector<pwl2limodsat::Variable> nnOutputVariables);
+        void addNNmodsat(lukaFormula::FormulaContainer& container, const std::vector<pwl2limodsat::Variable>& nnOutputVariables);
+        void addNNsmt(lukaFormula::SmtWriter& writer, const std::vector<pwl2limodsat::Variable>& nnOutputVariables);
 
     private:
         std::vector<std::string> liModSatFileName;
@@ -0,0 +1,60 @@
+#ifndef PWLSTREAMSINK_H
+#define PWLSTREAMSINK_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include "reluka.h"
+#include "pwl2limodsat.h"
+
+namespace reluka
+{
+// Marks a prototype index that is not known to the file or the chunk
+const size_t NoStreamIdx = -1;
+
+// A region waiting to be written; a boundary whose flag in pooled is set
+// refers to a prototype of the chunk instead of one already in the file
+struct PendingRegion
+{
+    pwl2limodsat::LinearPieceData lpData;
+    pwl2limodsat::BoundaryCollection bound;
+    std::vector<char> pooled;
+};
+
+// Regions buffered by one worker for one output, together with copies of
+// the prototypes they use that have not been written to the file yet.
+// owners holds the worker's index of each pooled prototype, or NoStreamIdx
+// once the worker has discarded it. Only the first boundProtNum prototypes
+// and regionsNum regions are buffered; the slots after them are kept when
+// the chunk is cleared, so later chunks reuse their memory.
+struct PwlStreamChunk
+{
+    pwl2limodsat::BoundaryPrototypeCollection boundProtData;
+    std::vector<pwl2limodsat::BoundProtIndex> owners;
+    std::vector<PendingRegion> regions;
+    size_t boundProtNum = 0;
+    size_t regionsNum = 0;
+
+    size_t addBoundProt(const pwl2limodsat::BoundaryPrototype& boundProt, pwl2limodsat::BoundProtIndex owner);
+    PendingRegion& addRegion();
+    void clear() { owners.clear(); boundProtNum = 0; regionsNum = 0; }
+};
+
+// Writes a .pwl file incrementally: every chunk appends the boundary
+// prototypes it introduces followed by its regions.
+class PwlStreamSink
+{
+    public:
+        PwlStreamSink(std::string fileName);
+
+        void write(const PwlStreamChunk& chunk, std::vector<pwl2limodsat::BoundProtIndex>& fileIdx);
+
+    private:
+        std::mutex sinkMutex;
+        std::ofstream pwlFile;
+        pwl2limodsat::BoundProtIndex boundProtCounter = 0;
+};
+}
+
+#endif // PWLSTREAMSINK_H
@@ -0,0 +1,83 @@
+#ifndef REGIONSTORE_H
+#define REGIONSTORE_H
+
+#include <vector>
+#include <cstdint>
+#include "reluka.h"
+#include "pwl2limodsat.h"
+
+namespace reluka
+{
+// Marks a piece or node with no parent activation pattern
+const size_t NoRegionNode = -1;
+
+// Compact storage of the regions found by the enumeration. A node holds the
+// activation pattern of one layer, two bits per neuron (cutting, sign), over
+// the contiguous prototypes starting at firstIdx, and points to the node of
+// the previous layer, so sibling regions share their common prefix. A node
+// over prototypes that are not contiguous, such as a region read back from
+// a checkpoint, lists their indexes instead. A piece holds its linear
+// function, its last node and the at most two output boundaries closing it.
+// Explicit boundary lists are only built on demand.
+class RegionStore
+{
+    public:
+        RegionStore(size_t outputsNum = 0) : pieces(outputsNum) {}
+
+        size_t addNode(size_t parent,
+                       pwl2limodsat::BoundProtIndex firstIdx,
+                       const std::vector<char>& cutting,
+                       const std::vector<pwl2limodsat::BoundarySymbol>& symbols);
+        size_t addNode(size_t parent, const pwl2limodsat::BoundaryCollection& bound);
+        void addPiece(size_t outIdx,
+                      size_t node,
+                      const pwl2limodsat::LinearPieceData& lpData,
+                      const pwl2limodsat::BoundaryCollection& tail);
+
+        size_t getPiecesNum(size_t outIdx) const { return pieces.at(outIdx).size(); }
+        void expandPiece(size_t outIdx, size_t pieceIdx, pwl2limodsat::RegionalLinearPieceData& rlpData) const;
+        pwl2limodsat::PiecewiseLinearFunctionData getPwlData(size_t outIdx) const;
+
+        void append(RegionStore& other, pwl2limodsat::BoundProtIndex boundProtOffset);
+        void clear();
+
+        // Prototype indexes used by some piece, and their replacement by
+        // indexes of a deduplicated table when the pieces are expanded
+        void markReferenced(std::vector<char>& referenced) const;
+        void setBoundaryRemap(std::vector<pwl2limodsat::Boundary>&& remap) { boundaryRemap = std::move(remap); }
+
+    private:
+        // firstIdx of a listed node is the position of its first index in
+        // listedIdx
+        struct Node
+        {
+            size_t parent;
+            pwl2limodsat::BoundProtIndex firstIdx;
+            size_t bitOffset;
+            uint32_t width;
+            bool listed;
+        };
+
+        struct Piece
+        {
+            pwl2limodsat::LinearPieceData lpData;
+            size_t node;
+            pwl2limodsat::Boundary tail[2];
+            unsigned char tailNum;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<uint64_t> bits;
+        std::vector<pwl2limodsat::BoundProtIndex> listedIdx;
+        std::vector<std::vector<Piece>> pieces;
+        std::vector<pwl2limodsat::Boundary> boundaryRemap;
+
+        void remapBoundaries(pwl2limodsat::BoundaryCollection& bound) const;
+        pwl2limodsat::BoundProtIndex nodeIdx(const Node& node, size_t j) const { return ( node.listed ? listedIdx[node.firstIdx + j] : node.firstIdx + j ); }
+
+        bool getBit(size_t bitIdx) const { return ( bits[bitIdx / 64] >> ( bitIdx % 64 ) ) & 1; }
+        void setBit(size_t bitIdx) { bits[bitIdx / 64] |= ( (uint64_t) 1 << ( bitIdx % 64 ) ); }
+};
+}
+
+#endif // REGIONSTORE_H
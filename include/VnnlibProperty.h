@@ -21,6 +21,7 @@ class VnnlibProperty
         std::vector<unsigned> getNnOutputIndexes();
         pwl2limodsat::Variable getVariable(unsigned nnOutputIdx);
         void printLipropFile();
+        void printSmtFile();
 
     protected:
 
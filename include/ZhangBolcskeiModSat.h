@@ -21,6 +21,8 @@ class ZhangBolcskeiModSat
         size_t getOutputDimension() { return neuralNetwork.back().size(); }
         void representZBmodsat();
         void printZBmodsatFile(unsigned outIdx);
+        void printZBmodsatBinaryFile(unsigned outIdx, bool compression);
+        void printZBsmtFile(unsigned outIdx);
 
     private:
         std::vector<std::string> liModSatFileName;
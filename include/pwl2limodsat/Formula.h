@@ -32,6 +32,7 @@
 #include <vector>
 #include <tuple>
 #include <fstream>
+#include <string>
 #include "pwl2limodsat.h"
 
 namespace lukaFormula
@@ -79,19 +80,24 @@ class Formula
         void addImplication(const Formula& form);
         void addMaximum(const Formula& form);
         void addMinimum(const Formula& form);
+        // Shared construction: a formula is appended once and its last unit,
+        // its value, is referenced by index by the operations appended over
+        // it. The value of the whole formula is the unit created last.
+        UnitIndex addSharedFormula(const Formula& form);
+        UnitIndex addOperation(UnitIndex unit1, UnitIndex unit2, LogicalSymbol binSym);
         pwl2limodsat::Variable shiftVariables(std::vector<pwl2limodsat::Variable> newInputs,
                                               pwl2limodsat::Variable byVar);
         unsigned getUnitCounter() const { return unitCounter; }
-        std::vector<UnitClause> getUnitClauses() const { return unitClauses; }
-        std::vector<Negation> getNegations() const { return negations; }
-        std::vector<LDisjunction> getLDisjunctions() const { return lDisjunctions; }
-        std::vector<LDisjunction> getLConjunctions() const { return lConjunctions; }
-        std::vector<Equivalence> getEquivalences() const { return equivalences; }
-        std::vector<Implication> getImplications() const { return implications; }
-        std::vector<Maximum> getMaximums() const { return maximums; }
-        std::vector<Minimum> getMinimums() const { return minimums; }
+        const std::vector<UnitClause>& getUnitClauses() const { return unitClauses; }
+        const std::vector<Negation>& getNegations() const { return negations; }
+        const std::vector<LDisjunction>& getLDisjunctions() const { return lDisjunctions; }
+        const std::vector<LConjunction>& getLConjunctions() const { return lConjunctions; }
+        const std::vector<Equivalence>& getEquivalences() const { return equivalences; }
+        const std::vector<Implication>& getImplications() const { return implications; }
+        const std::vector<Maximum>& getMaximums() const { return maximums; }
+        const std::vector<Minimum>& getMinimums() const { return minimums; }
 
-        void print(std::ofstream *output);
+        void print(std::ofstream *output) const;
 
     private:
         bool emptyFormula = false;
@@ -105,10 +111,114 @@ class Formula
         std::vector<Maximum> maximums;
         std::vector<Minimum> minimums;
 
+        std::vector<BinaryOperation>& binaryOperations(LogicalSymbol binSym);
+        template<class T> static void reserveUnits(std::vector<T>& units, size_t addedUnitsNum);
+        void addShiftedOperations(std::vector<BinaryOperation>& binOps, const std::vector<BinaryOperation>& addedBinOps);
         void addUnits(const Formula& form);
         void addBinaryOperation(const Formula& form, LogicalSymbol binSym);
 };
 
+// Text of formulas in the .limodsat unit format, kept in a buffer written
+// to the stream in blocks of WRITE_BUFFER_SIZE; the buffer grows as it is
+// filled, so a writer meant for a whole file is kept for the whole file. A writer without a stream only
+// accumulates, so formulas may be serialised apart, e.g. one writer per
+// thread, and the buffers appended in order to the writer of the file.
+class FormulaWriter
+{
+    public:
+        FormulaWriter(std::ostream *output = nullptr);
+        FormulaWriter(const FormulaWriter&) = delete;
+        FormulaWriter& operator=(const FormulaWriter&) = delete;
+        ~FormulaWriter();
+
+        void write(const Formula& form);
+        void write(const std::string& text);
+        void write(const char *text);
+        void write(const FormulaWriter& other);
+        void writeNumber(long long int value);
+        void flush();
+        void clear() { buffer.clear(); }
+
+    private:
+        std::ostream *stream;
+        std::string buffer;
+
+        void writeFull();
+        void writeOperation(UnitIndex unit, const char *name, const BinaryOperation& binOp);
+};
+
+// Formulas as SMT-LIB2 in the QF_LRA logic, through a FormulaWriter. The
+// connectives are defined once as functions over reals in [0,1] and every
+// unit of a formula is named by a define-fun over the names of its operands,
+// so a unit referenced many times is written once. Variable i is X<i>.
+class SmtWriter
+{
+    public:
+        SmtWriter(std::ostream *output);
+
+        void writeHeader(pwl2limodsat::Variable maxVar);
+        void definePhi(const Formula& form);
+        void assertFormula(const Formula& form);
+        void assertNotFormula(const Formula& form);
+        void writeCheckSat(bool phiValue);
+        void flush() { writer.flush(); }
+
+    private:
+        FormulaWriter writer;
+        unsigned long long int formulasNum = 0;
+
+        void writeUnitName(UnitIndex unit);
+        void writeLiteral(Literal lit);
+        void defineUnits(const Formula& form);
+};
+
+enum SectionKind { PhiSection, PhiSetSection, PremisesSection, ConclusionSection };
+enum ContainerContent { LimodsatContent, ConsContent, SatContent };
+
+// Binary counterpart of the .limodsat and .liprop files: a table of sections
+// of formulas, each formula a sequence of unit records whose fields are
+// varints and whose operands are stored relative to their unit, optionally
+// compressed with zlib. Sections are encoded when added and decoded when
+// asked for, so a file is loaded back into formulas without parsing text.
+class FormulaContainer
+{
+    public:
+        FormulaContainer(ContainerContent containerContent = LimodsatContent, pwl2limodsat::Variable maxVar = 0);
+
+        void addSection(SectionKind kind, const Formula& form);
+        void addSection(SectionKind kind, const std::vector<Formula>& forms);
+        void write(std::string fileName, bool compression);
+        void read(std::string fileName);
+
+        ContainerContent getContent() const { return content; }
+        pwl2limodsat::Variable getMaxVariable() const { return maxVariable; }
+        size_t getSectionsNum() const { return sections.size(); }
+        SectionKind getSectionKind(size_t i) const { return sections.at(i).kind; }
+        size_t getFormulasNum(size_t i) const { return sections.at(i).formulasNum; }
+        std::vector<Formula> getFormulas(size_t i) const;
+
+    private:
+        struct Section
+        {
+            SectionKind kind;
+            size_t formulasNum;
+            std::string data;
+        };
+
+        ContainerContent content;
+        pwl2limodsat::Variable maxVariable;
+        std::vector<Section> sections;
+
+        static void writeVarint(std::string& data, unsigned long long int value);
+        static unsigned long long int readVarint(const std::string& data, size_t& pos);
+        static unsigned long long int readBounded(const std::string& data, size_t& pos, unsigned long long int maxValue);
+        static void writeSigned(std::string& data, long long int value);
+        static long long int readSigned(const std::string& data, size_t& pos);
+        static UnitIndex readOperand(const std::string& data, size_t& pos, UnitIndex unit);
+        static void encode(std::string& data, const Formula& form);
+        static Formula decode(const std::string& data, size_t& pos);
+};
+
 typedef std::vector<Formula> ModsatSet;
 
 struct Modsat
@@ -50,11 +50,13 @@ class LinearPiece
         ~LinearPiece();
 
         void representModsat();
-        Modsat getRepresentationModsat();
+        const Modsat& getRepresentationModsat();
         Formula getRepresentativeFormula();
         ModsatSet getModsatSet();
         void printModsatSetAs(std::ofstream *output, std::string intro);
+        void printModsatSetAs(FormulaWriter& writer, std::string intro);
         void printModsatSet(std::ofstream *output);
+        void printModsatSet(FormulaWriter& writer);
         void printLimodsatFile();
 
         static Formula zeroFormula(VariableManager *var);
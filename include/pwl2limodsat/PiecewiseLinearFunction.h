@@ -29,6 +29,9 @@
 #ifndef PIECEWISELINEARFUNCTION_H
 #define PIECEWISELINEARFUNCTION_H
 
+#include <cstdint>
+#include <atomic>
+#include <mutex>
 #include "RegionalLinearPiece.h"
 
 namespace pwl2limodsat
@@ -53,6 +56,7 @@ class PiecewiseLinearFunction
                                 const BoundaryPrototypeCollection& boundProtData,
                                 std::string inputFileName);
         ~PiecewiseLinearFunction();
+        void setExact(bool exactComparisons);
         bool hasLatticeProperty();
         unsigned long long int latticePropertyCounter();
         void representModsat();
@@ -60,6 +64,8 @@ class PiecewiseLinearFunction
         std::vector<RegionalLinearPiece> getLinearPieceCollection();
         Formula getLatticeFormula();
         void printLimodsatFile();
+        void printLimodsatBinaryFile(bool compression);
+        void printSmtFile();
 
     protected:
 
@@ -76,10 +82,33 @@ class PiecewiseLinearFunction
         bool ownVariableManager = false;
         bool modsatTranslation = false;
 
+        // Bit k of row i of comparedAbove (comparedBelow) tells whether piece
+        // k lies above (below) piece i on the region of piece i
+        std::vector<uint64_t> comparedAbove;
+        std::vector<uint64_t> comparedBelow;
+        std::vector<char> rowComputed;
+        size_t rowWords = 0;
+        bool comparedPositions = false;
+        bool latticePropertyViolation = false;
+
+        bool isComparedAbove(size_t i, size_t k) const { return ( comparedAbove[i * rowWords + k / 64] >> ( k % 64 ) ) & 1; }
+        void comparedPositionsWorker(std::atomic<size_t>& nextRow,
+                                     std::mutex& finishedMutex,
+                                     std::vector<size_t>& finishedRows,
+                                     std::atomic<bool>& violation,
+                                     bool checkLatticeProperty);
+        bool computeComparedPositions(bool checkLatticeProperty);
+        bool latticePropertyHolds(size_t i, size_t j) const;
+        void violationsWorker(std::atomic<size_t>& nextRow,
+                              std::atomic<unsigned long long int>& violationsNum,
+                              bool stopAtViolation);
+        unsigned long long int countViolations(bool stopAtViolation);
+        unsigned workersNum();
+
         void setProcessingMode(ProcessingMode mode) { processingMode = mode; }
         void representPiecesModSat();
-        std::vector<Formula> partialPhiOmega(unsigned thread, unsigned compByThread);
-        void representLatticeFormula(unsigned maxThreadsNum);
+        void representLatticeFormula();
+        void printModsatSets(size_t begin, size_t end, lukaFormula::FormulaWriter *writer);
 };
 }
 
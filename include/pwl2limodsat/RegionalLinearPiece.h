@@ -29,8 +29,14 @@
 #ifndef REGIONALLINEARPIECE_H
 #define REGIONALLINEARPIECE_H
 
+#include <memory>
 #include "LinearPiece.h"
 
+namespace soplex
+{
+class SoPlex;
+}
+
 namespace pwl2limodsat
 {
 class RegionalLinearPiece : public LinearPiece
@@ -41,7 +47,11 @@ class RegionalLinearPiece : public LinearPiece
                             VariableManager *varMan);
         bool comparedIsAbove(const RegionalLinearPiece& comparedRlp);
         bool comparedIsBelow(const RegionalLinearPiece& comparedRlp);
-        LinearPieceData getLinearPieceData() const { return linearPieceData; }
+        void comparedPositions(const std::vector<RegionalLinearPiece>& comparedRlps,
+                               std::vector<char>& comparedAbove,
+                               std::vector<char>& comparedBelow);
+        const LinearPieceData& getLinearPieceData() const { return linearPieceData; }
+        void setExact(bool exactComparisons) { exact = exactComparisons; }
 
     protected:
 
@@ -50,6 +60,23 @@ class RegionalLinearPiece : public LinearPiece
         const BoundaryPrototypeCollection *boundaryPrototypeData;
         enum Position { ComparedIsAbove, ComparedIsBelow };
 
+        // Solutions of earlier LPs over the region, dim coordinates each;
+        // a comparison failing at one of them needs no LP
+        std::vector<double> samples;
+        size_t samplesNum = 0;
+
+        // Objective of the comparison being made, refilled by each one
+        std::vector<float> objFunc;
+
+        // Comparisons whose float maximum is close to the tolerance are
+        // decided by a rational LP
+        bool exact = false;
+
+        void regionLp(soplex::SoPlex& sop);
+        bool sampleExceeds(const std::vector<float>& objFunc, float K);
+        bool exactPosition(Position pos, const RegionalLinearPiece& comparedRlp);
+        void addSample(soplex::SoPlex& sop);
+        bool position(std::unique_ptr<soplex::SoPlex>& sop, Position pos, const RegionalLinearPiece& comparedRlp);
         bool position(Position pos, const RegionalLinearPiece& comparedRlp);
 };
 }
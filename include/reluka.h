@@ -10,6 +10,20 @@ typedef std::vector<NodeCoefficient> Node;
 typedef std::vector<Node> Layer;
 typedef std::vector<Layer> NeuralNetworkData;
 
+// Row-major dense matrix kept in one contiguous block
+struct FlatMatrix
+{
+    FlatMatrix() {}
+    FlatMatrix(size_t rowsNum, size_t colsNum) : rows(rowsNum), cols(colsNum), data(rowsNum * colsNum, 0) {}
+
+    double *row(size_t i) { return data.data() + i * cols; }
+    const double *row(size_t i) const { return data.data() + i * cols; }
+
+    size_t rows = 0;
+    size_t cols = 0;
+    std::vector<double> data;
+};
+
 enum BoundProtPosition { Under, Cutting, Over };
 }
 
@@ -9,12 +9,28 @@
 #include "InequalitySatisfiability.h"
 #include "VnnlibProperty.h"
 #include "GlobalRobustness.h"
+#include "NetworkSimplifier.h"
 
 bool pwl = false;
+bool pwlStream = false;
+bool pwlReduce = false;
+bool pwlCoalesce = false;
+bool pwlCheckpoint = false;
+bool pwlResume = false;
+unsigned checkpointInterval = 0;
+bool enumerationStats = false;
+unsigned progressInterval = 0;
+unsigned maxConflicts = 0;
+bool pwlDomain = false;
+bool simplify = false;
+bool exactDecisions = false;
 bool verifyLatticeProperty = true;
 bool latticePropertyCounter = false;
 bool limodsat = false;
 bool zblimodsat = false;
+bool smt2 = false;
+bool binaryOutput = false;
+bool compressOutput = false;
 bool hasOnnx = false;
 bool ineqcons = false;
 bool ineqsat = false;
@@ -23,6 +39,7 @@ bool vnnlib = false;
 bool acasxu = false;
 
 std::string onnxFileName;
+std::string domainFileName;
 std::string ineqconsFileName;
 std::string ineqsatFileName;
 std::string vnnlibFileName;
@@ -43,6 +60,31 @@ void usage()
     usage(emptyString);
 }
 
+reluka::InputDomain inputDomain(reluka::OnnxParser& onnx)
+{
+    reluka::InputDomain domain(onnx.getInputDim());
+
+    if ( pwlDomain )
+        domain.readLimits(domainFileName);
+
+    return domain;
+}
+
+// The network to translate, simplified over the domain when asked to
+reluka::NeuralNetworkData neuralNetwork(reluka::OnnxParser& onnx, const reluka::InputDomain& domain)
+{
+    if ( !simplify )
+        return onnx.getNeuralNetwork();
+
+    reluka::NetworkSimplifier simplifier( onnx.getNeuralNetwork(), domain );
+    return simplifier.getNeuralNetwork();
+}
+
+reluka::NeuralNetworkData neuralNetwork(reluka::OnnxParser& onnx)
+{
+    return neuralNetwork(onnx, reluka::InputDomain(onnx.getInputDim()));
+}
+
 void onlyIntermediateSteps()
 {
     reluka::OnnxParser onnx( onnxFileName, acasxu );
@@ -50,44 +92,107 @@ void onlyIntermediateSteps()
 //    std::cout << "==WARNING: The neural network will not be normalized==" << std::endl;
 //    std::cout << "The input must be a rational McNaughton neural network" << std::endl << std::endl;
 
-    if ( pwl )
+    if ( pwl && pwlStream )
+    {
+        // Streamed regions are not kept in memory, so nothing can be built on them
+        if ( limodsat || smt2 || latticePropertyCounter || pwlReduce || pwlCoalesce )
+            throw std::invalid_argument("Streamed pwl files cannot be further processed.");
+        if ( pwlCheckpoint || pwlResume )
+            throw std::invalid_argument("Streamed pwl files cannot be checkpointed.");
+
+        reluka::InputDomain domain = inputDomain(onnx);
+        reluka::NeuralNetwork nn( neuralNetwork(onnx, domain), onnx.getOnnxFileName() );
+
+        nn.setInputDomain(domain);
+        nn.setExact(exactDecisions);
+        nn.setProgress(progressInterval);
+        nn.setMaxConflicts(maxConflicts);
+        nn.streamPwlFiles();
+
+        if ( enumerationStats )
+            nn.printStatsFile();
+    }
+    else if ( pwl )
     {
-        reluka::NeuralNetwork nn( onnx.getNeuralNetwork(), onnx.getOnnxFileName() );
+        reluka::InputDomain domain = inputDomain(onnx);
+        reluka::NeuralNetwork nn( neuralNetwork(onnx, domain), onnx.getOnnxFileName() );
+
+        nn.setInputDomain(domain);
+        nn.setExact(exactDecisions);
+        if ( pwlCheckpoint )
+            nn.setCheckpoint(checkpointInterval);
+        if ( pwlResume )
+            nn.resumeCheckpoint();
+        nn.setProgress(progressInterval);
+        nn.setMaxConflicts(maxConflicts);
+
         nn.buildPwlData();
 
+        if ( enumerationStats )
+            nn.printStatsFile();
+
+        if ( pwlCoalesce )
+            nn.coalescePwlData();
+        if ( pwlReduce )
+            nn.reducePwlData();
+
         for ( size_t outIdx = 0; outIdx < nn.getOutputDimension(); outIdx++ )
         {
             nn.printPwlFile(outIdx);
 
-            if ( limodsat || verifyLatticeProperty || latticePropertyCounter )
+            if ( limodsat || smt2 || verifyLatticeProperty || latticePropertyCounter )
             {
                 pwl2limodsat::PiecewiseLinearFunction pwl( nn.getPwlData((unsigned) outIdx),
                                                            nn.getBoundProtData(),
-                                                           nn.getPwlFileName((unsigned) outIdx) );
+                                                           nn.getPwlFileName((unsigned) outIdx),
+                                                           true );
+
+                pwl.setExact(exactDecisions);
 
                 if ( verifyLatticeProperty && !pwl.hasLatticeProperty() )
                     throw std::domain_error("Pre-regional format without the lattice property.");
                 else if ( latticePropertyCounter )
                     std::cout << "out" << outIdx << ": " << pwl.latticePropertyCounter() << std::endl;
 
-                if ( limodsat )
+                if ( limodsat && binaryOutput )
+                    pwl.printLimodsatBinaryFile(compressOutput);
+                else if ( limodsat )
                     pwl.printLimodsatFile();
+
+                if ( smt2 )
+                    pwl.printSmtFile();
             }
         }
     }
     else if ( zblimodsat )
     {
-        reluka::ZhangBolcskeiModSat zbms( onnx.getNeuralNetwork(), onnx.getOnnxFileName() );
+        reluka::ZhangBolcskeiModSat zbms( neuralNetwork(onnx), onnx.getOnnxFileName() );
 
         for ( size_t outIdx = 0; outIdx < zbms.getOutputDimension(); outIdx++ )
-            zbms.printZBmodsatFile((unsigned) outIdx);
+        {
+            if ( binaryOutput )
+                zbms.printZBmodsatBinaryFile((unsigned) outIdx, compressOutput);
+            else
+                zbms.printZBmodsatFile((unsigned) outIdx);
+
+            if ( smt2 )
+                zbms.printZBsmtFile((unsigned) outIdx);
+        }
     }
     else
     {
-        reluka::NeuralNetworkModSat nnms( onnx.getNeuralNetwork(), onnx.getOnnxFileName() );
+        reluka::NeuralNetworkModSat nnms( neuralNetwork(onnx), onnx.getOnnxFileName() );
 
         for ( size_t outIdx = 0; outIdx < nnms.getOutputDimension(); outIdx++ )
-            nnms.printNNmodsatFile((unsigned) outIdx);
+        {
+            if ( binaryOutput )
+                nnms.printNNmodsatBinaryFile((unsigned) outIdx, compressOutput);
+            else
+                nnms.printNNmodsatFile((unsigned) outIdx);
+
+            if ( smt2 )
+                nnms.printNNsmtFile((unsigned) outIdx);
+        }
     }
 }
 
@@ -101,9 +206,15 @@ void inequalityConstraintsRoutine()
     for ( auto& lim : inputLimits )
         onnx.normalizeInput(lim.first, lim.second.first, lim.second.second);
 
-    reluka::NeuralNetworkModSat nnms( onnx.getNeuralNetwork(), ineqcons.getNnOutputIndexes(), onnx.getOnnxFileName(), true );
+    reluka::NeuralNetworkModSat nnms( neuralNetwork(onnx), ineqcons.getNnOutputIndexes(), onnx.getOnnxFileName(), true );
     ineqcons.buildIneqconsProperty( nnms.getOriginalOutputLim() );
-    ineqcons.printLiproperty( &nnms );
+    if ( binaryOutput )
+        ineqcons.printLipropertyBinary( &nnms, compressOutput );
+    else
+        ineqcons.printLiproperty( &nnms );
+
+    if ( smt2 )
+        ineqcons.printLipropertySmt( &nnms );
 }
 
 void inequalitySatisfiabilityRoutine()
@@ -116,9 +227,15 @@ void inequalitySatisfiabilityRoutine()
     for ( auto& lim : inputLimits )
         onnx.normalizeInput(lim.first, lim.second.first, lim.second.second);
 
-    reluka::NeuralNetworkModSat nnms( onnx.getNeuralNetwork(), ineqsat.getNnOutputIndexes(), onnx.getOnnxFileName(), true );
+    reluka::NeuralNetworkModSat nnms( neuralNetwork(onnx), ineqsat.getNnOutputIndexes(), onnx.getOnnxFileName(), true );
     ineqsat.buildIneqsatProperty( nnms.getOriginalOutputLim() );
-    ineqsat.printLiproperty( &nnms );
+    if ( binaryOutput )
+        ineqsat.printLipropertyBinary( &nnms, compressOutput );
+    else
+        ineqsat.printLiproperty( &nnms );
+
+    if ( smt2 )
+        ineqsat.printLipropertySmt( &nnms );
 }
 
 /*
@@ -206,6 +323,57 @@ int main(int argc, char **argv)
 
         if ( arg.compare("-pwl") == 0 )
             pwl = true;
+        else if ( arg.compare("-pwlstream") == 0 )
+        {
+            pwl = true;
+            pwlStream = true;
+        }
+        else if ( arg.compare("-reduce") == 0 )
+            pwlReduce = true;
+        else if ( arg.compare("-coalesce") == 0 )
+            pwlCoalesce = true;
+        else if ( arg.compare("-checkpoint") == 0 )
+        {
+            argNum++;
+            arg = argv[argNum];
+            if ( arg.empty() || ( arg.find_first_not_of("0123456789") != std::string::npos ) )
+                throw std::invalid_argument("Missing checkpoint interval in seconds.");
+            checkpointInterval = std::stoul(arg);
+            pwlCheckpoint = true;
+        }
+        else if ( arg.compare("-resume") == 0 )
+            pwlResume = true;
+        else if ( arg.compare("-stats") == 0 )
+            enumerationStats = true;
+        else if ( arg.compare("-progress") == 0 )
+        {
+            argNum++;
+            arg = argv[argNum];
+            if ( arg.empty() || ( arg.find_first_not_of("0123456789") != std::string::npos ) )
+                throw std::invalid_argument("Missing progress interval in seconds.");
+            progressInterval = std::stoul(arg);
+        }
+        else if ( arg.compare("-conflicts") == 0 )
+        {
+            argNum++;
+            arg = argv[argNum];
+            if ( arg.empty() || ( arg.find_first_not_of("0123456789") != std::string::npos ) )
+                throw std::invalid_argument("Missing conflict store size.");
+            maxConflicts = std::stoul(arg);
+        }
+        else if ( arg.compare("-domain") == 0 )
+        {
+            argNum++;
+            arg = argv[argNum];
+            if ( arg.compare(0, 1, "-") == 0 )
+                throw std::invalid_argument("Missing input domain file path.");
+            domainFileName = arg;
+            pwlDomain = true;
+        }
+        else if ( arg.compare("-simplify") == 0 )
+            simplify = true;
+        else if ( arg.compare("-exact") == 0 )
+            exactDecisions = true;
         else if ( arg.compare("-without-lp") == 0 )
             verifyLatticeProperty = false;
         else if ( arg.compare("-lpcount") == 0 )
@@ -217,6 +385,15 @@ int main(int argc, char **argv)
             limodsat = true;
         else if ( arg.compare("-zblimodsat") == 0 )
             zblimodsat = true;
+        else if ( arg.compare("-smt2") == 0 )
+            smt2 = true;
+        else if ( arg.compare("-binary") == 0 )
+            binaryOutput = true;
+        else if ( arg.compare("-compress") == 0 )
+        {
+            binaryOutput = true;
+            compressOutput = true;
+        }
         else if ( arg.compare("-ineqcons") == 0 )
         {
             argNum++;
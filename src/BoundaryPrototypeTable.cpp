@@ -0,0 +1,80 @@
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include "BoundaryPrototypeTable.h"
+
+namespace reluka
+{
+BoundaryPrototypeTable::BoundaryPrototypeTable(double tolerance) :
+    tol(tolerance) {}
+
+bool BoundaryPrototypeTable::canonicalize(const pwl2limodsat::BoundaryPrototype& boundProt,
+                                          pwl2limodsat::BoundaryPrototype& canonical)
+{
+    double maxAbs = 0;
+    for ( pwl2limodsat::BoundaryCoefficient coeff : boundProt )
+        maxAbs = std::max(maxAbs, std::abs(coeff));
+
+    canonical = boundProt;
+
+    if ( maxAbs == 0 )
+        return false;
+
+    bool flipped = false;
+    for ( size_t i = 1; i < boundProt.size(); i++ )
+        if ( std::abs(boundProt.at(i)) > tol * maxAbs )
+        {
+            flipped = ( boundProt.at(i) < 0 );
+            break;
+        }
+
+    for ( pwl2limodsat::BoundaryCoefficient& coeff : canonical )
+        coeff = ( flipped ? -coeff : coeff ) / maxAbs;
+
+    return flipped;
+}
+
+size_t BoundaryPrototypeTable::hash(const pwl2limodsat::BoundaryPrototype& canonical)
+{
+    size_t seed = canonical.size();
+
+    // Coefficients are hashed on a grid coarser than the tolerance; rows
+    // falling on different sides of a grid line are simply not merged
+    for ( pwl2limodsat::BoundaryCoefficient coeff : canonical )
+    {
+        long long quantized = std::llround(coeff / ( 16 * tol ));
+        seed ^= std::hash<long long>()(quantized) + 0x9e3779b97f4a7c15 + ( seed << 6 ) + ( seed >> 2 );
+    }
+
+    return seed;
+}
+
+pwl2limodsat::Boundary BoundaryPrototypeTable::intern(const pwl2limodsat::BoundaryPrototype& boundProt)
+{
+    pwl2limodsat::BoundaryPrototype canonical;
+    bool flipped = canonicalize(boundProt, canonical);
+
+    std::vector<pwl2limodsat::BoundProtIndex>& bucket = buckets[hash(canonical)];
+
+    for ( pwl2limodsat::BoundProtIndex idx : bucket )
+    {
+        const pwl2limodsat::BoundaryPrototype& stored = canonicalData.at(idx);
+        bool equal = ( stored.size() == canonical.size() );
+
+        for ( size_t i = 0; equal && ( i < canonical.size() ); i++ )
+            if ( std::abs(stored.at(i) - canonical.at(i)) > tol )
+                equal = false;
+
+        if ( equal )
+            return pwl2limodsat::Boundary(idx, ( flipped == (bool) canonicalFlipped.at(idx) ? pwl2limodsat::GeqZero
+                                                                                          : pwl2limodsat::LeqZero ));
+    }
+
+    bucket.push_back(boundProtData.size());
+    boundProtData.push_back(boundProt);
+    canonicalData.push_back(canonical);
+    canonicalFlipped.push_back(flipped);
+
+    return pwl2limodsat::Boundary(boundProtData.size() - 1, pwl2limodsat::GeqZero);
+}
+}
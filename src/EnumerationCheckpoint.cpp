@@ -0,0 +1,361 @@
+#include <stdexcept>
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+#include "EnumerationCheckpoint.h"
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+namespace reluka
+{
+EnumerationCheckpoint::EnumerationCheckpoint(const NeuralNetworkData& neuralNetwork,
+                                             const std::vector<unsigned>& nnOutputIndexes,
+                                             const InputDomain& inputDomain,
+                                             bool exactDecisions) :
+    networkHash(FNV_OFFSET),
+    exact(exactDecisions),
+    outputIndexes(nnOutputIndexes),
+    domain(inputDomain),
+    pwlData(nnOutputIndexes.size())
+{
+    for ( const Layer& layer : neuralNetwork )
+    {
+        networkShape.push_back(layer.size());
+        networkShape.push_back(layer.at(0).size());
+
+        // FNV-1a over the bytes of every weight and bias
+        for ( const Node& node : layer )
+            for ( const NodeCoefficient& coef : node )
+            {
+                const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&coef);
+
+                for ( size_t i = 0; i < sizeof(NodeCoefficient); i++ )
+                {
+                    networkHash ^= bytes[i];
+                    networkHash *= FNV_PRIME;
+                }
+            }
+    }
+}
+
+// Regions refer to the checkpoint's own prototypes; equal prototypes coming
+// from different workers are written once
+void EnumerationCheckpoint::addRegions(const RegionStore& regions, const pwl2limodsat::BoundaryPrototypeCollection& regionsBoundProtData)
+{
+    std::vector<char> referenced(regionsBoundProtData.size(), 0);
+    regions.markReferenced(referenced);
+
+    std::vector<pwl2limodsat::BoundProtIndex> newIdx(regionsBoundProtData.size(), 0);
+    for ( size_t i = 0; i < regionsBoundProtData.size(); i++ )
+        if ( referenced.at(i) )
+        {
+            std::map<pwl2limodsat::BoundaryPrototype, pwl2limodsat::BoundProtIndex>::iterator it = boundProtIdx.find(regionsBoundProtData.at(i));
+
+            if ( it == boundProtIdx.end() )
+            {
+                it = boundProtIdx.insert(std::make_pair(regionsBoundProtData.at(i), boundProtData.size())).first;
+                boundProtData.push_back(regionsBoundProtData.at(i));
+            }
+
+            newIdx.at(i) = it->second;
+        }
+
+    pwl2limodsat::RegionalLinearPieceData rlpData;
+
+    for ( size_t outIdx = 0; outIdx < pwlData.size(); outIdx++ )
+        for ( size_t i = 0; i < regions.getPiecesNum(outIdx); i++ )
+        {
+            regions.expandPiece(outIdx, i, rlpData);
+
+            for ( pwl2limodsat::Boundary& bound : rlpData.bound )
+                bound.first = newIdx.at(bound.first);
+
+            pwlData.at(outIdx).push_back(rlpData);
+        }
+}
+
+void EnumerationCheckpoint::writeBoundProtData(std::ofstream& checkpointFile, const pwl2limodsat::BoundaryPrototypeCollection& data)
+{
+    checkpointFile << data.size() << "\n";
+
+    for ( const pwl2limodsat::BoundaryPrototype& boundProt : data )
+    {
+        checkpointFile << boundProt.size();
+
+        for ( pwl2limodsat::BoundaryCoefficient coef : boundProt )
+            checkpointFile << " " << coef;
+
+        checkpointFile << "\n";
+    }
+}
+
+void EnumerationCheckpoint::writeBoundary(std::ofstream& checkpointFile, const pwl2limodsat::Boundary& bound)
+{
+    checkpointFile << " " << ( bound.second == pwl2limodsat::GeqZero ? "g " : "l " ) << bound.first;
+}
+
+// The file is written aside and renamed over the previous checkpoint, so an
+// interruption while writing leaves the previous one usable
+void EnumerationCheckpoint::write(std::string fileName)
+{
+    std::string tmpFileName = fileName + ".tmp";
+
+    {
+        std::ofstream checkpointFile(tmpFileName);
+
+        if ( !checkpointFile.is_open() )
+            throw std::invalid_argument("Unable to open checkpoint file.");
+
+        checkpointFile << std::setprecision(std::numeric_limits<pwl2limodsat::BoundaryCoefficient>::max_digits10);
+
+        checkpointFile << "checkpoint\n";
+
+        checkpointFile << "shape " << networkShape.size();
+        for ( size_t dim : networkShape )
+            checkpointFile << " " << dim;
+
+        checkpointFile << "\nweights " << networkHash;
+        checkpointFile << "\nexact " << exact;
+
+        checkpointFile << "\noutputs " << outputIndexes.size();
+        for ( unsigned outputIdx : outputIndexes )
+            checkpointFile << " " << outputIdx;
+
+        checkpointFile << "\ndomain " << domain.getDimension();
+        for ( size_t i = 0; i < domain.getDimension(); i++ )
+            checkpointFile << " " << domain.getLower(i) << " " << domain.getUpper(i);
+
+        checkpointFile << "\nconstraints ";
+        writeBoundProtData(checkpointFile, domain.getConstraintProts());
+        checkpointFile << domain.getConstraints().size();
+        for ( const pwl2limodsat::Boundary& constraint : domain.getConstraints() )
+            writeBoundary(checkpointFile, constraint);
+
+        checkpointFile << "\nprototypes ";
+        writeBoundProtData(checkpointFile, boundProtData);
+
+        for ( size_t outIdx = 0; outIdx < pwlData.size(); outIdx++ )
+        {
+            checkpointFile << "regions " << pwlData.at(outIdx).size() << "\n";
+
+            for ( const pwl2limodsat::RegionalLinearPieceData& rlpData : pwlData.at(outIdx) )
+            {
+                checkpointFile << rlpData.lpData.size();
+                for ( const pwl2limodsat::LinearPieceCoefficient& coef : rlpData.lpData )
+                    checkpointFile << " " << coef.first << " " << coef.second;
+
+                checkpointFile << " " << rlpData.bound.size();
+                for ( const pwl2limodsat::Boundary& bound : rlpData.bound )
+                    writeBoundary(checkpointFile, bound);
+
+                checkpointFile << "\n";
+            }
+        }
+
+        checkpointFile << "tasks " << tasks.size() << "\n";
+
+        for ( const EnumerationTask& task : tasks )
+        {
+            checkpointFile << "task " << task.layerNum << "\n";
+            writeBoundProtData(checkpointFile, task.inputValues);
+            writeBoundProtData(checkpointFile, task.boundProtData);
+
+            checkpointFile << task.boundData.size();
+            for ( const pwl2limodsat::Boundary& bound : task.boundData )
+                writeBoundary(checkpointFile, bound);
+
+            checkpointFile << "\n" << task.prefix.size();
+            for ( pwl2limodsat::BoundarySymbol symbol : task.prefix )
+                checkpointFile << ( symbol == pwl2limodsat::GeqZero ? " g" : " l" );
+
+            checkpointFile << "\n" << task.resumeIterations.size() << "\n";
+            for ( const std::vector<pwl2limodsat::BoundarySymbol>& iteration : task.resumeIterations )
+            {
+                checkpointFile << iteration.size();
+                for ( pwl2limodsat::BoundarySymbol symbol : iteration )
+                    checkpointFile << ( symbol == pwl2limodsat::GeqZero ? " g" : " l" );
+
+                checkpointFile << "\n";
+            }
+        }
+
+        checkpointFile << "end\n";
+
+        if ( !checkpointFile.good() )
+            throw std::runtime_error("Unable to write checkpoint file.");
+    }
+
+    if ( std::rename(tmpFileName.c_str(), fileName.c_str()) != 0 )
+        throw std::runtime_error("Unable to replace checkpoint file.");
+}
+
+void EnumerationCheckpoint::readKeyword(std::ifstream& checkpointFile, std::string keyword)
+{
+    std::string word;
+
+    if ( !( checkpointFile >> word ) || ( word != keyword ) )
+        throw std::invalid_argument("Not in checkpoint file format.");
+}
+
+size_t EnumerationCheckpoint::readSize(std::ifstream& checkpointFile)
+{
+    size_t value;
+
+    if ( !( checkpointFile >> value ) )
+        throw std::invalid_argument("Not in checkpoint file format.");
+
+    return value;
+}
+
+pwl2limodsat::BoundarySymbol EnumerationCheckpoint::readSymbol(std::ifstream& checkpointFile)
+{
+    char symbol;
+
+    if ( !( checkpointFile >> symbol ) || ( ( symbol != 'g' ) && ( symbol != 'l' ) ) )
+        throw std::invalid_argument("Not in checkpoint file format.");
+
+    return ( symbol == 'g' ? pwl2limodsat::GeqZero : pwl2limodsat::LeqZero );
+}
+
+void EnumerationCheckpoint::readBoundProtData(std::ifstream& checkpointFile, pwl2limodsat::BoundaryPrototypeCollection& data)
+{
+    data.resize(readSize(checkpointFile));
+
+    for ( pwl2limodsat::BoundaryPrototype& boundProt : data )
+    {
+        boundProt.resize(readSize(checkpointFile));
+
+        for ( pwl2limodsat::BoundaryCoefficient& coef : boundProt )
+            if ( !( checkpointFile >> coef ) )
+                throw std::invalid_argument("Not in checkpoint file format.");
+    }
+}
+
+void EnumerationCheckpoint::read(std::string fileName)
+{
+    std::ifstream checkpointFile(fileName);
+
+    if ( !checkpointFile.is_open() )
+        throw std::invalid_argument("Unable to open checkpoint file.");
+
+    readKeyword(checkpointFile, "checkpoint");
+
+    readKeyword(checkpointFile, "shape");
+    std::vector<size_t> fileShape(readSize(checkpointFile));
+    for ( size_t& dim : fileShape )
+        dim = readSize(checkpointFile);
+
+    readKeyword(checkpointFile, "weights");
+    uint64_t fileHash;
+    if ( !( checkpointFile >> fileHash ) )
+        throw std::invalid_argument("Not in checkpoint file format.");
+
+    readKeyword(checkpointFile, "exact");
+    size_t fileExact = readSize(checkpointFile);
+
+    readKeyword(checkpointFile, "outputs");
+    std::vector<unsigned> fileOutputIndexes(readSize(checkpointFile));
+    for ( unsigned& outputIdx : fileOutputIndexes )
+        outputIdx = readSize(checkpointFile);
+
+    readKeyword(checkpointFile, "domain");
+    InputDomain fileDomain(readSize(checkpointFile));
+    for ( size_t i = 0; i < fileDomain.getDimension(); i++ )
+    {
+        double inputMin, inputMax;
+
+        if ( !( checkpointFile >> inputMin >> inputMax ) )
+            throw std::invalid_argument("Not in checkpoint file format.");
+
+        fileDomain.setLimits(i+1, inputMin, inputMax);
+    }
+
+    readKeyword(checkpointFile, "constraints");
+    pwl2limodsat::BoundaryPrototypeCollection constraintProts;
+    readBoundProtData(checkpointFile, constraintProts);
+    pwl2limodsat::BoundaryCollection constraints(readSize(checkpointFile));
+    for ( pwl2limodsat::Boundary& constraint : constraints )
+    {
+        constraint.second = readSymbol(checkpointFile);
+        constraint.first = readSize(checkpointFile);
+
+        if ( constraint.first >= constraintProts.size() )
+            throw std::invalid_argument("Not in checkpoint file format.");
+
+        fileDomain.addConstraint(constraintProts.at(constraint.first), constraint.second);
+    }
+
+    if ( ( fileShape != networkShape ) || ( fileHash != networkHash ) || ( fileOutputIndexes != outputIndexes ) || !( fileDomain == domain ) )
+        throw std::invalid_argument("Checkpoint does not match the neural network.");
+
+    if ( fileExact != exact )
+        throw std::invalid_argument("Checkpoint was written with another -exact setting.");
+
+    readKeyword(checkpointFile, "prototypes");
+    readBoundProtData(checkpointFile, boundProtData);
+
+    boundProtIdx.clear();
+    for ( size_t i = 0; i < boundProtData.size(); i++ )
+        boundProtIdx.insert(std::make_pair(boundProtData.at(i), i));
+
+    for ( size_t outIdx = 0; outIdx < pwlData.size(); outIdx++ )
+    {
+        readKeyword(checkpointFile, "regions");
+        pwlData.at(outIdx).resize(readSize(checkpointFile));
+
+        for ( pwl2limodsat::RegionalLinearPieceData& rlpData : pwlData.at(outIdx) )
+        {
+            rlpData.lpData.resize(readSize(checkpointFile));
+            for ( pwl2limodsat::LinearPieceCoefficient& coef : rlpData.lpData )
+                if ( !( checkpointFile >> coef.first >> coef.second ) )
+                    throw std::invalid_argument("Not in checkpoint file format.");
+
+            rlpData.bound.resize(readSize(checkpointFile));
+            for ( pwl2limodsat::Boundary& bound : rlpData.bound )
+            {
+                bound.second = readSymbol(checkpointFile);
+                bound.first = readSize(checkpointFile);
+
+                if ( bound.first >= boundProtData.size() )
+                    throw std::invalid_argument("Not in checkpoint file format.");
+            }
+        }
+    }
+
+    readKeyword(checkpointFile, "tasks");
+    tasks.resize(readSize(checkpointFile));
+
+    for ( EnumerationTask& task : tasks )
+    {
+        readKeyword(checkpointFile, "task");
+        task.layerNum = readSize(checkpointFile);
+        readBoundProtData(checkpointFile, task.inputValues);
+        readBoundProtData(checkpointFile, task.boundProtData);
+
+        task.boundData.resize(readSize(checkpointFile));
+        for ( pwl2limodsat::Boundary& bound : task.boundData )
+        {
+            bound.second = readSymbol(checkpointFile);
+            bound.first = readSize(checkpointFile);
+
+            if ( bound.first >= task.boundProtData.size() )
+                throw std::invalid_argument("Not in checkpoint file format.");
+        }
+
+        task.prefix.resize(readSize(checkpointFile));
+        for ( pwl2limodsat::BoundarySymbol& symbol : task.prefix )
+            symbol = readSymbol(checkpointFile);
+
+        task.resumeIterations.resize(readSize(checkpointFile));
+        for ( std::vector<pwl2limodsat::BoundarySymbol>& iteration : task.resumeIterations )
+        {
+            iteration.resize(readSize(checkpointFile));
+            for ( pwl2limodsat::BoundarySymbol& symbol : iteration )
+                symbol = readSymbol(checkpointFile);
+        }
+    }
+
+    readKeyword(checkpointFile, "end");
+}
+}
@@ -0,0 +1,127 @@
+#include "EnumerationScheduler.h"
+
+namespace reluka
+{
+EnumerationScheduler::EnumerationScheduler(unsigned workersNum)
+{
+    if ( workersNum == 0 )
+        workersNum = 1;
+
+    for ( unsigned i = 0; i < workersNum; i++ )
+        queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue));
+}
+
+void EnumerationScheduler::push(unsigned workerId, EnumerationTask&& task)
+{
+    pendingTasks++;
+
+    {
+        std::lock_guard<std::mutex> lock(queues.at(workerId)->queueMutex);
+        queues.at(workerId)->tasks.push_back(std::move(task));
+        queuedTasks++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+    }
+    idleCondition.notify_one();
+}
+
+bool EnumerationScheduler::tryPop(unsigned workerId, EnumerationTask& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(queues.at(workerId)->queueMutex);
+        if ( !queues.at(workerId)->tasks.empty() )
+        {
+            task = std::move(queues.at(workerId)->tasks.back());
+            queues.at(workerId)->tasks.pop_back();
+            queuedTasks--;
+            return true;
+        }
+    }
+
+    for ( size_t i = 1; i < queues.size(); i++ )
+    {
+        size_t victim = ( workerId + i ) % queues.size();
+
+        std::lock_guard<std::mutex> lock(queues.at(victim)->queueMutex);
+        if ( !queues.at(victim)->tasks.empty() )
+        {
+            task = std::move(queues.at(victim)->tasks.front());
+            queues.at(victim)->tasks.pop_front();
+            queuedTasks--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool EnumerationScheduler::pop(unsigned workerId, EnumerationTask& task)
+{
+    while ( true )
+    {
+        if ( aborted || suspended )
+            return false;
+
+        if ( tryPop(workerId, task) )
+            return true;
+
+        std::unique_lock<std::mutex> lock(idleMutex);
+
+        if ( ( pendingTasks == 0 ) || aborted || suspended )
+            return false;
+
+        idleWorkers++;
+        idleCondition.wait(lock, [this] { return ( queuedTasks > 0 ) || ( pendingTasks == 0 ) || aborted || suspended; });
+        idleWorkers--;
+    }
+}
+
+void EnumerationScheduler::taskDone()
+{
+    if ( --pendingTasks == 0 )
+    {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+        }
+        idleCondition.notify_all();
+    }
+}
+
+void EnumerationScheduler::abort()
+{
+    aborted = true;
+
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+    }
+    idleCondition.notify_all();
+}
+
+// Stops handing out tasks; the queued ones are left for drain
+void EnumerationScheduler::suspend()
+{
+    suspended = true;
+
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+    }
+    idleCondition.notify_all();
+}
+
+void EnumerationScheduler::drain(std::vector<EnumerationTask>& tasks)
+{
+    for ( size_t i = 0; i < queues.size(); i++ )
+    {
+        std::lock_guard<std::mutex> lock(queues.at(i)->queueMutex);
+
+        for ( EnumerationTask& task : queues.at(i)->tasks )
+            tasks.push_back(std::move(task));
+
+        pendingTasks -= queues.at(i)->tasks.size();
+        queuedTasks -= queues.at(i)->tasks.size();
+        queues.at(i)->tasks.clear();
+    }
+}
+}
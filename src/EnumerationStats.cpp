@@ -0,0 +1,82 @@
+#include <algorithm>
+#include "EnumerationStats.h"
+
+namespace reluka
+{
+void EnumerationStats::updatePeakBoundProtData(size_t boundProtDataSize)
+{
+    if ( boundProtDataSize > peakBoundProtData )
+        peakBoundProtData = boundProtDataSize;
+}
+
+void EnumerationStats::updatePeakConflicts(size_t conflictsNum)
+{
+    if ( conflictsNum > peakConflicts )
+        peakConflicts = conflictsNum;
+}
+
+// Peaks are kept as the largest of the workers, since each worker holds its
+// own prototypes and conflicts
+void EnumerationStats::add(const EnumerationStats& other)
+{
+    if ( layers.size() < other.layers.size() )
+        layers.resize(other.layers.size());
+
+    for ( size_t i = 0; i < other.layers.size(); i++ )
+    {
+        LayerStats& layerStats = layers.at(i);
+        const LayerStats& otherStats = other.layers.at(i);
+
+        layerStats.positionCalls += otherStats.positionCalls;
+        layerStats.positionLps += otherStats.positionLps;
+        layerStats.positionLpSeconds += otherStats.positionLpSeconds;
+        layerStats.positionExact += otherStats.positionExact;
+        layerStats.feasibilityChecks += otherStats.feasibilityChecks;
+        layerStats.feasibleChecks += otherStats.feasibleChecks;
+        layerStats.infeasibleChecks += otherStats.infeasibleChecks;
+        layerStats.feasibilityLps += otherStats.feasibilityLps;
+        layerStats.feasibilityLpSeconds += otherStats.feasibilityLpSeconds;
+        layerStats.feasibilityExactLps += otherStats.feasibilityExactLps;
+        layerStats.conflictsLearned += otherStats.conflictsLearned;
+        layerStats.conflictRejections += otherStats.conflictRejections;
+        layerStats.regions += otherStats.regions;
+    }
+
+    tasksNum += other.tasksNum;
+    peakBoundProtData = std::max(peakBoundProtData, other.peakBoundProtData);
+    peakConflicts = std::max(peakConflicts, other.peakConflicts);
+}
+
+void EnumerationStats::writeJson(std::ofstream& statsFile, const std::string& indent) const
+{
+    statsFile << "{\n";
+    statsFile << indent << "  \"tasks\": " << tasksNum << ",\n";
+    statsFile << indent << "  \"peakBoundProtData\": " << peakBoundProtData << ",\n";
+    statsFile << indent << "  \"peakConflicts\": " << peakConflicts << ",\n";
+    statsFile << indent << "  \"layers\": [";
+
+    for ( size_t i = 0; i < layers.size(); i++ )
+    {
+        const LayerStats& layerStats = layers.at(i);
+
+        statsFile << ( i == 0 ? "\n" : ",\n" );
+        statsFile << indent << "    { \"layer\": " << i
+                  << ", \"boundProtPositionCalls\": " << layerStats.positionCalls
+                  << ", \"boundProtPositionLps\": " << layerStats.positionLps
+                  << ", \"boundProtPositionLpSeconds\": " << layerStats.positionLpSeconds
+                  << ", \"boundProtPositionExact\": " << layerStats.positionExact
+                  << ", \"feasibilityChecks\": " << layerStats.feasibilityChecks
+                  << ", \"feasible\": " << layerStats.feasibleChecks
+                  << ", \"infeasible\": " << layerStats.infeasibleChecks
+                  << ", \"feasibilityLps\": " << layerStats.feasibilityLps
+                  << ", \"feasibilityLpSeconds\": " << layerStats.feasibilityLpSeconds
+                  << ", \"feasibilityExactLps\": " << layerStats.feasibilityExactLps
+                  << ", \"conflictsLearned\": " << layerStats.conflictsLearned
+                  << ", \"conflictRejections\": " << layerStats.conflictRejections
+                  << ", \"regions\": " << layerStats.regions << " }";
+    }
+
+    statsFile << "\n" << indent << "  ]\n";
+    statsFile << indent << "}";
+}
+}
@@ -0,0 +1,459 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include "soplex.h"
+#include "FeasibilityEngine.h"
+
+#define FARKAS_TOLERANCE 1e-9
+#define WITNESS_MARGIN 1e-6
+#define MAX_CONFLICTS 100000
+
+namespace reluka
+{
+FeasibilityEngine::FeasibilityEngine(const InputDomain& inputDomain, bool exactDecisions) :
+    sop(nullptr),
+    inputDim(inputDomain.getDimension()),
+    domain(inputDomain),
+    exact(exactDecisions),
+    maxConflicts(MAX_CONFLICTS)
+{
+    initialize();
+}
+
+FeasibilityEngine::~FeasibilityEngine()
+{
+    delete sop;
+}
+
+void FeasibilityEngine::initialize()
+{
+    delete sop;
+    sop = new soplex::SoPlex;
+
+    soplex::DSVector dummycol(0);
+    for ( size_t i = 0; i < inputDim; i++ )
+        sop->addColReal(soplex::LPCol(0, dummycol, domain.getUpper(i), domain.getLower(i)));
+
+    for ( const pwl2limodsat::Boundary& constraint : domain.getConstraints() )
+        addRow(domain.getConstraintProts().at(constraint.first), constraint.second);
+
+    sop->setIntParam(soplex::SoPlex::VERBOSITY, soplex::SoPlex::VERBOSITY_ERROR);
+    sop->setIntParam(soplex::SoPlex::OBJSENSE, soplex::SoPlex::OBJSENSE_MAXIMIZE);
+
+    rowBounds.clear();
+    rowProtData.clear();
+    activeBounds.clear();
+    conflicts.clear();
+    conflictIndex.clear();
+    deadConflictsNum = 0;
+    primal.reDim(inputDim);
+
+    // The box centre witnesses a plain box; a constrained domain is solved once
+    knownFeasibility.assign(1, Feasible);
+    witnesses = domain.getCentre();
+    witnessed.assign(1, true);
+    if ( !domain.getConstraints().empty() )
+        knownFeasibility.back() = ( solve() ? Feasible : Infeasible );
+}
+
+void FeasibilityEngine::pushBoundary(const pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
+                                     const pwl2limodsat::Boundary& bound)
+{
+    const pwl2limodsat::BoundaryPrototype& boundProt = boundProtData.at(bound.first);
+    pwl2limodsat::BoundarySymbol boundSymbol = bound.second;
+
+    addRow(boundProt, boundSymbol);
+
+    rowBounds.push_back(bound);
+    rowProtData.push_back(&boundProtData);
+    activeBounds.insert(std::upper_bound(activeBounds.begin(), activeBounds.end(), bound), bound);
+
+    size_t depth = knownFeasibility.size();
+    if ( witnesses.size() < ( depth + 1 ) * inputDim )
+        witnesses.resize(std::max(2 * witnesses.size(), ( depth + 1 ) * inputDim));
+
+    // Adding a row to an infeasible system keeps it infeasible, and the
+    // parent's witness point proves feasibility whenever it satisfies the row
+    if ( knownFeasibility.back() == Infeasible )
+    {
+        knownFeasibility.push_back(Infeasible);
+        witnessed.push_back(false);
+    }
+    else if ( witnessed.back() && satisfies(witness(depth-1), boundProt, boundSymbol) )
+    {
+        std::copy(witness(depth-1), witness(depth), witness(depth));
+        knownFeasibility.push_back(Feasible);
+        witnessed.push_back(true);
+    }
+    else
+    {
+        knownFeasibility.push_back(Unknown);
+        witnessed.push_back(false);
+    }
+}
+
+void FeasibilityEngine::popBoundary()
+{
+    if ( knownFeasibility.size() == 1 )
+        throw std::logic_error("No boundary to be removed from the feasibility engine.");
+
+    sop->removeRowReal(sop->numRows() - 1);
+
+    activeBounds.erase(std::lower_bound(activeBounds.begin(), activeBounds.end(), rowBounds.back()));
+    rowBounds.pop_back();
+    rowProtData.pop_back();
+    knownFeasibility.pop_back();
+    witnessed.pop_back();
+}
+
+void FeasibilityEngine::addRow(const pwl2limodsat::BoundaryPrototype& boundProt, pwl2limodsat::BoundarySymbol boundSymbol)
+{
+    rowVector.clear();
+    for ( size_t j = 1; j <= inputDim; j++ )
+        rowVector.add(j-1, boundProt.at(j));
+
+    lpRow.setRowVector(rowVector);
+
+    if ( boundSymbol == pwl2limodsat::GeqZero )
+    {
+        lpRow.setLhs(-boundProt.at(0));
+        lpRow.setRhs(soplex::infinity);
+    }
+    else
+    {
+        lpRow.setLhs(-soplex::infinity);
+        lpRow.setRhs(-boundProt.at(0));
+    }
+
+    sop->addRowReal(lpRow);
+}
+
+bool FeasibilityEngine::isActive(const pwl2limodsat::Boundary& bound) const
+{
+    return std::binary_search(activeBounds.begin(), activeBounds.end(), bound);
+}
+
+bool FeasibilityEngine::isFeasible()
+{
+    if ( ( knownFeasibility.back() == Unknown ) && hasKnownConflict() )
+    {
+        knownFeasibility.back() = Infeasible;
+        conflictHitsNum++;
+    }
+
+    if ( knownFeasibility.back() == Unknown )
+        knownFeasibility.back() = ( solve() ? Feasible : Infeasible );
+
+    return ( knownFeasibility.back() == Feasible );
+}
+
+// Solves the current rows, keeping the solution as witness when feasible
+// and the conflict proven by the Farkas certificate when infeasible
+bool FeasibilityEngine::solve()
+{
+    std::chrono::steady_clock::time_point lpStart = std::chrono::steady_clock::now();
+    sop->optimize();
+    lpSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - lpStart).count();
+    lpsNum++;
+
+    float Max = sop->objValueReal();
+
+    if ( Max < 0 )
+    {
+        bool storeFull = ( getLiveConflictsNum() >= maxConflicts );
+
+        if ( exact )
+        {
+            if ( !farkasProof(exactCombination, soplex::Rational(0)) )
+                return exactSolve();
+        }
+        else if ( storeFull || !farkasProof(floatCombination, (double) FARKAS_TOLERANCE) )
+            return false;
+
+        if ( !storeFull )
+            learnConflict();
+
+        return false;
+    }
+
+    sop->getPrimalReal(primal);
+
+    double *point = witness(getDepth());
+    for ( size_t i = 0; i < inputDim; i++ )
+        point[i] = primal[i];
+    witnessed.back() = true;
+
+    if ( exact && !satisfiesRows(point) )
+        return exactSolve();
+
+    return true;
+}
+
+// Decides the current rows by a rational LP. Its witness is rounded to
+// floating point and only kept while the rounded point stays in the region.
+bool FeasibilityEngine::exactSolve()
+{
+    std::chrono::steady_clock::time_point lpStart = std::chrono::steady_clock::now();
+    soplex::SoPlex exactSop;
+
+    exactSop.setIntParam(soplex::SoPlex::READMODE, soplex::SoPlex::READMODE_RATIONAL);
+    exactSop.setIntParam(soplex::SoPlex::SOLVEMODE, soplex::SoPlex::SOLVEMODE_RATIONAL);
+    exactSop.setIntParam(soplex::SoPlex::CHECKMODE, soplex::SoPlex::CHECKMODE_RATIONAL);
+    exactSop.setIntParam(soplex::SoPlex::SYNCMODE, soplex::SoPlex::SYNCMODE_AUTO);
+    exactSop.setRealParam(soplex::SoPlex::FEASTOL, 0.0);
+    exactSop.setRealParam(soplex::SoPlex::OPTTOL, 0.0);
+    exactSop.setIntParam(soplex::SoPlex::VERBOSITY, soplex::SoPlex::VERBOSITY_ERROR);
+
+    soplex::DSVectorRational dummycol(0);
+    for ( size_t i = 0; i < inputDim; i++ )
+        exactSop.addColRational(soplex::LPColRational(soplex::Rational(0),
+                                                      dummycol,
+                                                      soplex::Rational(domain.getUpper(i)),
+                                                      soplex::Rational(domain.getLower(i))));
+
+    size_t domainRowsNum = domain.getConstraints().size();
+
+    for ( size_t i = 0; i < domainRowsNum + rowBounds.size(); i++ )
+    {
+        bool domainRow = ( i < domainRowsNum );
+        const pwl2limodsat::Boundary& rowBound = ( domainRow ? domain.getConstraints().at(i) : rowBounds.at(i - domainRowsNum) );
+        const pwl2limodsat::BoundaryPrototype& rowProt = ( domainRow ? domain.getConstraintProts().at(rowBound.first)
+                                                                     : rowPrototype(i - domainRowsNum) );
+
+        soplex::DSVectorRational row(inputDim);
+        for ( size_t j = 1; j <= inputDim; j++ )
+            row.add(j-1, soplex::Rational(rowProt.at(j)));
+
+        if ( rowBound.second == pwl2limodsat::GeqZero )
+            exactSop.addRowRational(soplex::LPRowRational(-soplex::Rational(rowProt.at(0)), row, soplex::Rational(soplex::infinity)));
+        else
+            exactSop.addRowRational(soplex::LPRowRational(-soplex::Rational(soplex::infinity), row, -soplex::Rational(rowProt.at(0))));
+    }
+
+    soplex::SPxSolver::Status status = exactSop.optimize();
+    lpSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - lpStart).count();
+    exactLpsNum++;
+
+    if ( status == soplex::SPxSolver::INFEASIBLE )
+        return false;
+    else if ( status != soplex::SPxSolver::OPTIMAL )
+        throw std::runtime_error("Rational LP unable to decide the feasibility of a region.");
+
+    soplex::DVectorRational primal(inputDim);
+    exactSop.getPrimalRational(primal);
+
+    double *point = witness(getDepth());
+    for ( size_t i = 0; i < inputDim; i++ )
+        point[i] = double(primal[i]);
+
+    witnessed.back() = satisfiesRows(point);
+
+    return true;
+}
+
+bool FeasibilityEngine::satisfies(const double *point,
+                                  const pwl2limodsat::BoundaryPrototype& boundProt,
+                                  pwl2limodsat::BoundarySymbol boundSymbol)
+{
+    if ( exact )
+    {
+        soplex::Rational value(boundProt.at(0));
+        for ( size_t j = 1; j <= inputDim; j++ )
+            value += soplex::Rational(boundProt.at(j)) * soplex::Rational(point[j-1]);
+
+        if ( boundSymbol == pwl2limodsat::GeqZero )
+            return ( value >= soplex::Rational(0) );
+        else
+            return ( value <= soplex::Rational(0) );
+    }
+
+    // A witness found by the LP may lie outside its region by the solver's
+    // tolerance, so it only proves a boundary it satisfies by a margin
+    // scaled to the boundary's norm; points closer to it are left to the LP
+    double value = boundProt.at(0);
+    double norm = 0;
+    for ( size_t j = 1; j <= inputDim; j++ )
+    {
+        value += boundProt.at(j) * point[j-1];
+        norm += boundProt.at(j) * boundProt.at(j);
+    }
+
+    double margin = WITNESS_MARGIN * std::sqrt(norm);
+
+    if ( boundSymbol == pwl2limodsat::GeqZero )
+        return ( value >= margin );
+    else
+        return ( value <= -margin );
+}
+
+// Whether a point lies in the box and satisfies the domain constraints and
+// every boundary pushed
+bool FeasibilityEngine::satisfiesRows(const double *point)
+{
+    for ( size_t i = 0; i < inputDim; i++ )
+        if ( ( point[i] < domain.getLower(i) ) || ( point[i] > domain.getUpper(i) ) )
+            return false;
+
+    for ( const pwl2limodsat::Boundary& constraint : domain.getConstraints() )
+        if ( !satisfies(point, domain.getConstraintProts().at(constraint.first), constraint.second) )
+            return false;
+
+    for ( size_t i = 0; i < rowBounds.size(); i++ )
+        if ( !satisfies(point, rowPrototype(i), rowBounds.at(i).second) )
+            return false;
+
+    return true;
+}
+
+bool FeasibilityEngine::hasKnownConflict()
+{
+    std::map<pwl2limodsat::Boundary, std::vector<size_t>>::const_iterator it = conflictIndex.find(rowBounds.back());
+
+    if ( it == conflictIndex.end() )
+        return false;
+
+    for ( size_t conflictIdx : it->second )
+    {
+        if ( conflicts.at(conflictIdx).empty() )
+            continue;
+
+        bool contained = true;
+
+        for ( const pwl2limodsat::Boundary& bound : conflicts.at(conflictIdx) )
+            if ( !isActive(bound) )
+            {
+                contained = false;
+                break;
+            }
+
+        if ( contained )
+            return true;
+    }
+
+    return false;
+}
+
+// The rows with a nonzero Farkas multiplier form an infeasible subsystem
+// together with the input domain, kept in conflict. The certificate is checked by bounding the
+// combined row over the box, in the arithmetic of T, before it is trusted as
+// a conflict; the domain constraints always hold, so they take part in it
+// but not in the conflict.
+template<class T> bool FeasibilityEngine::farkasProof(std::vector<T>& combination, const T& tolerance)
+{
+    if ( !sop->hasDualFarkas() )
+        return false;
+
+    if ( farkas.dim() < sop->numRows() )
+        farkas.reDim(sop->numRows());
+    sop->getDualFarkasReal(farkas);
+
+    size_t domainRowsNum = domain.getConstraints().size();
+    combination.assign(inputDim, T(0));
+    conflict.clear();
+    T rowsMin(0), rowsMax(0);
+    bool rowsMinBounded = true, rowsMaxBounded = true;
+
+    for ( size_t i = 0; i < domainRowsNum + rowBounds.size(); i++ )
+    {
+        if ( std::abs(farkas[i]) <= FARKAS_TOLERANCE )
+            continue;
+
+        T multiplier(farkas[i]);
+        bool domainRow = ( i < domainRowsNum );
+        const pwl2limodsat::Boundary& rowBound = ( domainRow ? domain.getConstraints().at(i) : rowBounds.at(i - domainRowsNum) );
+        const pwl2limodsat::BoundaryPrototype& rowProt = ( domainRow ? domain.getConstraintProts().at(rowBound.first)
+                                                                     : rowPrototype(i - domainRowsNum) );
+
+        if ( !domainRow )
+            conflict.push_back(rowBound);
+
+        for ( size_t j = 0; j < inputDim; j++ )
+            combination[j] += multiplier * T(rowProt.at(j+1));
+
+        // Row i reads a.x >= -c for GeqZero and a.x <= -c for LeqZero
+        bool lowerSide = ( ( rowBound.second == pwl2limodsat::GeqZero ) == ( farkas[i] > 0 ) );
+        T value = -multiplier * T(rowProt.at(0));
+
+        if ( lowerSide )
+        {
+            rowsMin += value;
+            rowsMaxBounded = false;
+        }
+        else
+        {
+            rowsMax += value;
+            rowsMinBounded = false;
+        }
+    }
+
+    T boxMin(0), boxMax(0);
+
+    for ( size_t j = 0; j < inputDim; j++ )
+    {
+        if ( combination[j] > T(0) )
+        {
+            boxMax += combination[j] * T(domain.getUpper(j));
+            boxMin += combination[j] * T(domain.getLower(j));
+        }
+        else
+        {
+            boxMax += combination[j] * T(domain.getLower(j));
+            boxMin += combination[j] * T(domain.getUpper(j));
+        }
+    }
+
+    return ( rowsMinBounded && ( rowsMin > boxMax + tolerance ) ) ||
+           ( rowsMaxBounded && ( rowsMax < boxMin - tolerance ) );
+}
+
+void FeasibilityEngine::learnConflict()
+{
+    if ( conflict.empty() )
+        return;
+
+    for ( const pwl2limodsat::Boundary& bound : conflict )
+        conflictIndex[bound].push_back(conflicts.size());
+    conflicts.push_back(conflict);
+    learnedConflictsNum++;
+}
+
+void FeasibilityEngine::discardConflicts(pwl2limodsat::BoundProtIndex firstDiscardedIdx)
+{
+    std::map<pwl2limodsat::Boundary, std::vector<size_t>>::iterator first =
+        conflictIndex.lower_bound(pwl2limodsat::Boundary(firstDiscardedIdx, pwl2limodsat::GeqZero));
+
+    for ( std::map<pwl2limodsat::Boundary, std::vector<size_t>>::iterator it = first; it != conflictIndex.end(); it++ )
+        for ( size_t conflictIdx : it->second )
+            if ( !conflicts.at(conflictIdx).empty() )
+            {
+                conflicts.at(conflictIdx).clear();
+                deadConflictsNum++;
+            }
+
+    conflictIndex.erase(first, conflictIndex.end());
+
+    // Compact once most of the store refers to discarded prototypes
+    if ( 2 * deadConflictsNum > conflicts.size() )
+    {
+        std::vector<pwl2limodsat::BoundaryCollection> liveConflicts;
+
+        for ( pwl2limodsat::BoundaryCollection& conflict : conflicts )
+            if ( !conflict.empty() )
+                liveConflicts.push_back(std::move(conflict));
+
+        conflicts.swap(liveConflicts);
+        conflictIndex.clear();
+        deadConflictsNum = 0;
+
+        for ( size_t i = 0; i < conflicts.size(); i++ )
+            for ( const pwl2limodsat::Boundary& bound : conflicts.at(i) )
+                conflictIndex[bound].push_back(i);
+    }
+}
+
+void FeasibilityEngine::clear()
+{
+    initialize();
+}
+}
@@ -184,40 +184,41 @@ void GlobalRobustness::printLipropFile()
     for ( size_t i = 0; i < propertyFileName.size(); i++ )
     {
         std::ofstream propertyFile(propertyFileName.at(i));
-        propertyFile << "Cons" << std::endl << std::endl;
+        lukaFormula::FormulaWriter writer(&propertyFile);
+        writer.write("Cons\n\n");
 
         for ( pwl2limodsat::PiecewiseLinearFunction pwl : *nnOutputAddresses )
         {
             for ( pwl2limodsat::RegionalLinearPiece rlp : pwl.getLinearPieceCollection() ) {
-                rlp.printModsatSetAs(&propertyFile, "f:"); std::cout << "entrou" << std::endl;}
+                rlp.printModsatSetAs(writer, "f:"); std::cout << "entrou" << std::endl;}
 
-            propertyFile << "f:" << std::endl;
-            pwl.getLatticeFormula().print(&propertyFile);
+            writer.write("f:\n");
+            writer.write(pwl.getLatticeFormula());
         }
 
-        for ( lukaFormula::Formula cForm : cloneRepresentations )
+        for ( const lukaFormula::Formula& cForm : cloneRepresentations )
         {
-            propertyFile << "f:" << std::endl;
-            cForm.print(&propertyFile);
+            writer.write("f:\n");
+            writer.write(cForm);
         }
 
-        for ( lukaFormula::Formula epsForm : epsilonFormulas )
+        for ( const lukaFormula::Formula& epsForm : epsilonFormulas )
         {
-            propertyFile << "f:" << std::endl;
-            epsForm.print(&propertyFile);
+            writer.write("f:\n");
+            writer.write(epsForm);
         }
 
-        for ( lukaFormula::Formula pForm : perturbationFormulas )
+        for ( const lukaFormula::Formula& pForm : perturbationFormulas )
         {
-            propertyFile << "f:" << std::endl;
-            pForm.print(&propertyFile);
+            writer.write("f:\n");
+            writer.write(pForm);
         }
 
-        propertyFile << "f:" << std::endl;
-        premisseFormulas.at(i).print(&propertyFile);
+        writer.write("f:\n");
+        writer.write(premisseFormulas.at(i));
 
-        propertyFile << "C:" << std::endl;
-        conclusionFormulas.at(i).print(&propertyFile);
+        writer.write("C:\n");
+        writer.write(conclusionFormulas.at(i));
     }
 }
 }
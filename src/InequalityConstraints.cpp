@@ -3,6 +3,7 @@
 #include "NeuralNetwork.h"
 
 #include <iostream>
+#include <algorithm>
 
 namespace reluka
 {
@@ -140,17 +141,53 @@ void InequalityConstraints::printLiproperty(NeuralNetworkModSat *nnms)
         buildIneqconsProperty(nnms->getOriginalOutputLim());
 
     std::ofstream propertyFile(propertyFileName);
-    propertyFile << "Cons" << std::endl << std::endl;
+    lukaFormula::FormulaWriter writer(&propertyFile);
+    writer.write("Cons\n\n");
 
-    nnms->printNNmodsat(&propertyFile, nnOutputVariables);
+    nnms->printNNmodsat(writer, nnOutputVariables);
 
-    for ( lukaFormula::Formula form : premises )
+    for ( const lukaFormula::Formula& form : premises )
     {
-        propertyFile << "f:" << std::endl;
-        form.print(&propertyFile);
+        writer.write("f:\n");
+        writer.write(form);
     }
 
-    propertyFile << "C:" << std::endl;
-    conclusion.print(&propertyFile);
+    writer.write("C:\n");
+    writer.write(conclusion);
+}
+
+void InequalityConstraints::printLipropertyBinary(NeuralNetworkModSat *nnms, bool compression)
+{
+    if ( !ineqconsProperty )
+        buildIneqconsProperty(nnms->getOriginalOutputLim());
+
+    lukaFormula::FormulaContainer container(lukaFormula::ConsContent,
+                                            std::max(variableManager->currentVariable(), nnms->currentVariable()));
+
+    nnms->addNNmodsat(container, nnOutputVariables);
+    container.addSection(lukaFormula::PremisesSection, premises);
+    container.addSection(lukaFormula::ConclusionSection, conclusion);
+
+    container.write(propertyFileName + ".bin", compression);
+}
+
+// The conclusion follows from the premises exactly when it cannot be
+// false while they hold, i.e. when the SMT-LIB2 instance is unsatisfiable
+void InequalityConstraints::printLipropertySmt(NeuralNetworkModSat *nnms)
+{
+    if ( !ineqconsProperty )
+        buildIneqconsProperty(nnms->getOriginalOutputLim());
+
+    std::ofstream smtFile(propertyFileName.substr(0, propertyFileName.size()-7) + ".smt2");
+    lukaFormula::SmtWriter writer(&smtFile);
+
+    writer.writeHeader(std::max(variableManager->currentVariable(), nnms->currentVariable()));
+    nnms->addNNsmt(writer, nnOutputVariables);
+
+    for ( const lukaFormula::Formula& form : premises )
+        writer.assertFormula(form);
+
+    writer.assertNotFormula(conclusion);
+    writer.writeCheckSat(false);
 }
 }
@@ -3,6 +3,7 @@
 #include "NeuralNetwork.h"
 
 #include <iostream>
+#include <algorithm>
 
 namespace reluka
 {
@@ -145,14 +146,46 @@ void InequalitySatisfiability::printLiproperty(NeuralNetworkModSat *nnms)
         buildIneqsatProperty(nnms->getOriginalOutputLim());
 
     std::ofstream propertyFile(propertyFileName);
-    propertyFile << "Sat" << std::endl << std::endl;
+    lukaFormula::FormulaWriter writer(&propertyFile);
+    writer.write("Sat\n\n");
 
-    nnms->printNNmodsat(&propertyFile, nnOutputVariables);
+    nnms->printNNmodsat(writer, nnOutputVariables);
 
-    for ( lukaFormula::Formula form : instance )
+    for ( const lukaFormula::Formula& form : instance )
     {
-        propertyFile << "f:" << std::endl;
-        form.print(&propertyFile);
+        writer.write("f:\n");
+        writer.write(form);
     }
 }
+
+void InequalitySatisfiability::printLipropertyBinary(NeuralNetworkModSat *nnms, bool compression)
+{
+    if ( !ineqsatProperty )
+        buildIneqsatProperty(nnms->getOriginalOutputLim());
+
+    lukaFormula::FormulaContainer container(lukaFormula::SatContent,
+                                            std::max(variableManager->currentVariable(), nnms->currentVariable()));
+
+    nnms->addNNmodsat(container, nnOutputVariables);
+    container.addSection(lukaFormula::PremisesSection, instance);
+
+    container.write(propertyFileName + ".bin", compression);
+}
+
+void InequalitySatisfiability::printLipropertySmt(NeuralNetworkModSat *nnms)
+{
+    if ( !ineqsatProperty )
+        buildIneqsatProperty(nnms->getOriginalOutputLim());
+
+    std::ofstream smtFile(propertyFileName.substr(0, propertyFileName.size()-7) + ".smt2");
+    lukaFormula::SmtWriter writer(&smtFile);
+
+    writer.writeHeader(std::max(variableManager->currentVariable(), nnms->currentVariable()));
+    nnms->addNNsmt(writer, nnOutputVariables);
+
+    for ( const lukaFormula::Formula& form : instance )
+        writer.assertFormula(form);
+
+    writer.writeCheckSat(false);
+}
 }
@@ -0,0 +1,105 @@
+#include <stdexcept>
+#include <fstream>
+#include "InputDomain.h"
+
+namespace reluka
+{
+InputDomain::InputDomain(size_t inputDimension) :
+    lower(inputDimension, 0),
+    upper(inputDimension, 1) {}
+
+void InputDomain::setLimits(unsigned inputNum, double inputMin, double inputMax)
+{
+    if ( ( inputNum == 0 ) || ( inputNum > lower.size() ) )
+        throw std::invalid_argument("Input out of the neural network domain.");
+
+    if ( ( inputMin < 0 ) || ( inputMax > 1 ) || ( inputMin > inputMax ) )
+        throw std::invalid_argument("Input limits must be an interval within [0,1].");
+
+    lower.at(inputNum-1) = inputMin;
+    upper.at(inputNum-1) = inputMax;
+}
+
+void InputDomain::setLimits(const std::map<unsigned,std::pair<double,double>>& inputLimits)
+{
+    for ( auto& lim : inputLimits )
+        setLimits(lim.first, lim.second.first, lim.second.second);
+}
+
+void InputDomain::addConstraint(const pwl2limodsat::BoundaryPrototype& constraint, pwl2limodsat::BoundarySymbol symbol)
+{
+    if ( constraint.size() != lower.size() + 1 )
+        throw std::invalid_argument("Input constraint and neural network input dimensions differ.");
+
+    constraints.push_back(pwl2limodsat::Boundary(constraintProts.size(), symbol));
+    constraintProts.push_back(constraint);
+}
+
+// Reads the lines x<i> <min> <max> of an inequality constraints, inequality
+// satisfiability or domain file; other lines are ignored
+void InputDomain::readLimits(std::string domainFileName)
+{
+    std::ifstream domainFile(domainFileName);
+
+    if ( !domainFile.is_open() )
+        throw std::invalid_argument("Unable to open input domain file.");
+
+    std::string domainLine;
+
+    while ( getline(domainFile, domainLine) )
+    {
+        if ( domainLine.compare(0, 1, "x") != 0 )
+            continue;
+
+        size_t currentLinePosition = 1;
+        size_t blockLenght = domainLine.find_first_of(" ", currentLinePosition) - currentLinePosition;
+        unsigned inputNum = stoi(domainLine.substr(currentLinePosition, blockLenght));
+        currentLinePosition += blockLenght+1;
+        blockLenght = domainLine.find_first_of(" ", currentLinePosition) - currentLinePosition;
+        double inputMin = stod(domainLine.substr(currentLinePosition, blockLenght));
+        currentLinePosition += blockLenght+1;
+        blockLenght = domainLine.size() - currentLinePosition;
+        double inputMax = stod(domainLine.substr(currentLinePosition, blockLenght));
+
+        setLimits(inputNum, inputMin, inputMax);
+    }
+}
+
+std::vector<double> InputDomain::getCentre() const
+{
+    std::vector<double> centre(lower.size());
+
+    for ( size_t i = 0; i < lower.size(); i++ )
+        centre.at(i) = ( lower.at(i) + upper.at(i) ) / 2;
+
+    return centre;
+}
+
+void InputDomain::intervalBounds(const pwl2limodsat::BoundaryPrototype& boundProt, double& minValue, double& maxValue) const
+{
+    minValue = 0;
+    maxValue = 0;
+
+    for ( size_t i = 1; i < boundProt.size(); i++ )
+    {
+        if ( boundProt[i] > 0 )
+        {
+            maxValue += boundProt[i] * upper[i-1];
+            minValue += boundProt[i] * lower[i-1];
+        }
+        else
+        {
+            maxValue += boundProt[i] * lower[i-1];
+            minValue += boundProt[i] * upper[i-1];
+        }
+    }
+}
+
+bool InputDomain::operator==(const InputDomain& other) const
+{
+    return ( lower == other.lower ) &&
+           ( upper == other.upper ) &&
+           ( constraintProts == other.constraintProts ) &&
+           ( constraints == other.constraints );
+}
+}
@@ -0,0 +1,185 @@
+#include <stdexcept>
+#include <algorithm>
+#include "NetworkSimplifier.h"
+
+namespace reluka
+{
+NetworkSimplifier::NetworkSimplifier(const NeuralNetworkData& inputNeuralNetwork) :
+    neuralNetwork(inputNeuralNetwork),
+    domain(inputNeuralNetwork.front().at(0).size()-1) {}
+
+NetworkSimplifier::NetworkSimplifier(const NeuralNetworkData& inputNeuralNetwork, const InputDomain& inputDomain) :
+    neuralNetwork(inputNeuralNetwork),
+    domain(inputDomain)
+{
+    if ( domain.getDimension() != neuralNetwork.front().at(0).size()-1 )
+        throw std::invalid_argument("Input domain and neural network input dimensions differ.");
+}
+
+void NetworkSimplifier::neuronBounds(const Node& node,
+                                     const std::vector<double>& inputLower,
+                                     const std::vector<double>& inputUpper,
+                                     double& lower,
+                                     double& upper)
+{
+    lower = node.at(0);
+    upper = node.at(0);
+
+    for ( size_t i = 1; i < node.size(); i++ )
+    {
+        if ( node.at(i) > 0 )
+        {
+            lower += node.at(i) * inputLower.at(i-1);
+            upper += node.at(i) * inputUpper.at(i-1);
+        }
+        else
+        {
+            lower += node.at(i) * inputUpper.at(i-1);
+            upper += node.at(i) * inputLower.at(i-1);
+        }
+    }
+}
+
+void NetworkSimplifier::removeNeuron(size_t layerNum, size_t neuronIdx)
+{
+    neuralNetwork.at(layerNum).erase(neuralNetwork.at(layerNum).begin() + neuronIdx);
+
+    for ( Node& node : neuralNetwork.at(layerNum+1) )
+        node.erase(node.begin() + neuronIdx + 1);
+}
+
+// Coefficients are computed in double and stored as NodeCoefficient; a
+// change is only made when storing them loses nothing
+bool NetworkSimplifier::isExactCoefficient(double value)
+{
+    return ( (double) (NodeCoefficient) value == value );
+}
+
+// Replaces a hidden layer whose neurons are all active, or which has no
+// neurons left, and the next layer by their composition. Returns whether it
+// did, which it does not when a composed coefficient would be rounded.
+bool NetworkSimplifier::composeLayer(size_t layerNum)
+{
+    const Layer& layer = neuralNetwork.at(layerNum);
+    const Layer& nextLayer = neuralNetwork.at(layerNum+1);
+    size_t inputsNum = ( layerNum == 0 ? domain.getDimension() : neuralNetwork.at(layerNum-1).size() );
+
+    Layer composedLayer;
+    std::vector<double> composedNode(inputsNum+1);
+
+    for ( const Node& nextNode : nextLayer )
+    {
+        std::fill(composedNode.begin(), composedNode.end(), 0);
+        composedNode.at(0) = nextNode.at(0);
+
+        for ( size_t i = 0; i < layer.size(); i++ )
+            for ( size_t j = 0; j <= inputsNum; j++ )
+                composedNode.at(j) += (double) nextNode.at(i+1) * layer.at(i).at(j);
+
+        if ( !std::all_of(composedNode.begin(), composedNode.end(), isExactCoefficient) )
+            return false;
+
+        composedLayer.push_back(Node(composedNode.begin(), composedNode.end()));
+    }
+
+    neuralNetwork.at(layerNum+1) = composedLayer;
+    neuralNetwork.erase(neuralNetwork.begin() + layerNum);
+
+    return true;
+}
+
+// Simplifies a hidden layer given the bounds of its inputs and, unless the
+// layer was composed with the next one, turns them into the bounds of its
+// outputs. Returns whether the layer was composed.
+bool NetworkSimplifier::simplifyLayer(size_t layerNum, std::vector<double>& inputLower, std::vector<double>& inputUpper)
+{
+    Layer& layer = neuralNetwork.at(layerNum);
+    std::vector<double> lower(layer.size()), upper(layer.size());
+
+    for ( size_t i = 0; i < layer.size(); i++ )
+        neuronBounds(layer.at(i), inputLower, inputUpper, lower.at(i), upper.at(i));
+
+    // Backwards, so that removing a neuron keeps the indexes still to visit
+    for ( size_t i = layer.size(); i-- > 0; )
+    {
+        if ( upper.at(i) <= 0 )
+            deadNeuronsNum++;
+        else if ( ( lower.at(i) == upper.at(i) ) &&
+                  std::all_of(neuralNetwork.at(layerNum+1).begin(),
+                              neuralNetwork.at(layerNum+1).end(),
+                              [&](const Node& node) { return isExactCoefficient(node.at(0) + (double) node.at(i+1) * lower.at(i)); }) )
+        {
+            for ( Node& node : neuralNetwork.at(layerNum+1) )
+                node.at(0) += (double) node.at(i+1) * lower.at(i);
+
+            constantNeuronsNum++;
+        }
+        else
+            continue;
+
+        removeNeuron(layerNum, i);
+        lower.erase(lower.begin() + i);
+        upper.erase(upper.begin() + i);
+    }
+
+    for ( size_t i = 0; i < layer.size(); i++ )
+        for ( size_t j = layer.size()-1; j > i; j-- )
+            if ( ( layer.at(j) == layer.at(i) ) &&
+                 std::all_of(neuralNetwork.at(layerNum+1).begin(),
+                             neuralNetwork.at(layerNum+1).end(),
+                             [&](const Node& node) { return isExactCoefficient((double) node.at(i+1) + node.at(j+1)); }) )
+            {
+                for ( Node& node : neuralNetwork.at(layerNum+1) )
+                    node.at(i+1) += node.at(j+1);
+
+                removeNeuron(layerNum, j);
+                lower.erase(lower.begin() + j);
+                upper.erase(upper.begin() + j);
+                mergedNeuronsNum++;
+            }
+
+    if ( std::all_of(lower.begin(), lower.end(), [](double value) { return value >= 0; }) &&
+         composeLayer(layerNum) )
+    {
+        composedLayersNum++;
+        return true;
+    }
+
+    for ( size_t i = 0; i < lower.size(); i++ )
+    {
+        lower.at(i) = std::max(0.0, lower.at(i));
+        upper.at(i) = std::max(0.0, upper.at(i));
+    }
+
+    inputLower.swap(lower);
+    inputUpper.swap(upper);
+    return false;
+}
+
+void NetworkSimplifier::simplify()
+{
+    std::vector<double> inputLower(domain.getDimension()), inputUpper(domain.getDimension());
+
+    for ( size_t i = 0; i < domain.getDimension(); i++ )
+    {
+        inputLower.at(i) = domain.getLower(i);
+        inputUpper.at(i) = domain.getUpper(i);
+    }
+
+    size_t layerNum = 0;
+
+    while ( layerNum + 1 < neuralNetwork.size() )
+        if ( !simplifyLayer(layerNum, inputLower, inputUpper) )
+            layerNum++;
+
+    simplification = true;
+}
+
+const NeuralNetworkData& NetworkSimplifier::getNeuralNetwork()
+{
+    if ( !simplification )
+        simplify();
+
+    return neuralNetwork;
+}
+}
@@ -1,10 +1,19 @@
 #include <fstream>
+#include <cstdio>
 #include <cmath>
+#include <algorithm>
 #include <future>
+#include <iostream>
 #include "soplex.h"
 #include "NeuralNetwork.h"
+#include "BoundaryPrototypeTable.h"
+#include "EnumerationCheckpoint.h"
 
 #define PRECISION 1000000
+#define BOUND_TOLERANCE 1e-5
+#define STREAM_CHUNK_SIZE 4096
+#define PROTOTYPE_TOLERANCE 1e-9
+#define REDUNDANCY_TOLERANCE 1e-9
 
 namespace reluka
 {
@@ -27,14 +36,25 @@ NeuralNetwork::NeuralNetwork(const NeuralNetworkData& inputNeuralNetwork,
             nnOutputIndexes.push_back(outIdx);
 
     for ( size_t outIdx = 0; outIdx < nnOutputIndexes.size(); outIdx++ )
-    {
-        pwl2limodsat::PiecewiseLinearFunctionData emptyPwlData;
-        pwlData.push_back(emptyPwlData);
-
         pwlFileName.push_back(generalPwlFileName + "_" + std::to_string(nnOutputIndexes.at(outIdx)) + ".pwl");
-    }
+
+    checkpointFileName = generalPwlFileName + ".ckpt";
+    statsFileName = generalPwlFileName + "_stats.json";
+
+    regionStore = RegionStore(nnOutputIndexes.size());
+    inputDomain = InputDomain(getInputDimension());
 
     processingMode = ( multithreading ? Multi : Single );
+
+    for ( size_t layerNum = 0; layerNum < neuralNetwork.size(); layerNum++ )
+    {
+        flatWeights.push_back(FlatMatrix(neuralNetwork.at(layerNum).size(), neuralNetwork.at(layerNum).at(0).size()));
+
+        for ( size_t i = 0; i < neuralNetwork.at(layerNum).size(); i++ )
+            std::copy(neuralNetwork.at(layerNum).at(i).begin(),
+                      neuralNetwork.at(layerNum).at(i).end(),
+                      flatWeights.back().row(i));
+    }
 }
 
 NeuralNetwork::NeuralNetwork(const NeuralNetworkData& inputNeuralNetwork,
@@ -107,15 +127,69 @@ pwl2limodsat::LinearPieceCoefficient NeuralNetwork::dec2frac(T decValue)
 }
 
 BoundProtPosition NeuralNetwork::boundProtPosition(const pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
-                                                   pwl2limodsat::BoundProtIndex bIdx)
+                                                   pwl2limodsat::BoundProtIndex bIdx,
+                                                   LayerStats& stats)
 {
-    soplex::SoPlex sop;
+    stats.positionCalls++;
 
     pwl2limodsat::BoundaryCoefficient K = -boundProtData.at(bIdx).at(0);
 
+    // Over the input box the extrema are attained at a vertex, so interval
+    // arithmetic gives them exactly; the LP is only kept for values so close
+    // to K that the comparison depends on rounding. Constraints of the input
+    // domain are left to the feasibility checks, so a neuron fixed over them
+    // may still be found cutting here.
+    pwl2limodsat::BoundaryCoefficient intervalMax, intervalMin;
+    inputDomain.intervalBounds(boundProtData.at(bIdx), intervalMin, intervalMax);
+
+    pwl2limodsat::BoundaryCoefficient tolerance = BOUND_TOLERANCE * std::max(1.0, std::abs(K));
+
+    if ( intervalMin > K + tolerance )
+        return Over;
+    else if ( intervalMax < K - tolerance )
+        return Under;
+    else if ( ( intervalMin < K - tolerance ) && ( intervalMax > K + tolerance ) )
+        return Cutting;
+
+    // Coefficients and limits are doubles, hence rationals, so the vertex
+    // extrema are computed exactly instead of solving the LP
+    if ( exact )
+    {
+        const pwl2limodsat::BoundaryPrototype& boundProt = boundProtData.at(bIdx);
+        soplex::Rational exactMax(0), exactMin(0), exactK(K);
+
+        for ( size_t i = 1; i < boundProt.size(); i++ )
+        {
+            soplex::Rational coef(boundProt[i]);
+
+            if ( boundProt[i] > 0 )
+            {
+                exactMax += coef * soplex::Rational(inputDomain.getUpper(i-1));
+                exactMin += coef * soplex::Rational(inputDomain.getLower(i-1));
+            }
+            else
+            {
+                exactMax += coef * soplex::Rational(inputDomain.getLower(i-1));
+                exactMin += coef * soplex::Rational(inputDomain.getUpper(i-1));
+            }
+        }
+
+        stats.positionExact++;
+
+        if ( exactMin >= exactK )
+            return Over;
+        else if ( exactMax <= exactK )
+            return Under;
+        else
+            return Cutting;
+    }
+
+    std::chrono::steady_clock::time_point lpStart = std::chrono::steady_clock::now();
+    soplex::SoPlex sop;
+
     soplex::DSVector dummycol(0);
     for ( size_t i = 1; i < boundProtData.at(bIdx).size(); i++ )
-        sop.addColReal(soplex::LPCol(boundProtData.at(bIdx).at(i), dummycol, 1, 0));
+        sop.addColReal(soplex::LPCol(boundProtData.at(bIdx).at(i), dummycol, inputDomain.getUpper(i-1), inputDomain.getLower(i-1)));
 
     sop.setIntParam(soplex::SoPlex::VERBOSITY, soplex::SoPlex::VERBOSITY_ERROR);
     sop.setIntParam(soplex::SoPlex::OBJSENSE, soplex::SoPlex::OBJSENSE_MAXIMIZE);
@@ -126,6 +200,9 @@ BoundProtPosition NeuralNetwork::boundProtPosition(const pwl2limodsat::BoundaryP
     sop.optimize();
     float Min = sop.objValueReal();
 
+    stats.positionLps++;
+    stats.positionLpSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - lpStart).count();
+
     if ( (Min >= K) && (Max >= K) )
         return Over;
     else if ( (Max <= K) && (Min <= K) )
@@ -134,164 +211,263 @@ BoundProtPosition NeuralNetwork::boundProtPosition(const pwl2limodsat::BoundaryP
         return Cutting;
 }
 
-bool NeuralNetwork::feasibleBounds(const pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
-                                   const pwl2limodsat::BoundaryCollection& boundData)
+bool NeuralNetwork::checkFeasibility(EnumerationWorker& worker, size_t layerNum)
 {
-    soplex::SoPlex sop;
-
-    soplex::DSVector dummycol(0);
-    for ( size_t i = 1; i <= neuralNetwork.at(0).at(0).size()-1; i++ )
-        sop.addColReal(soplex::LPCol(0, dummycol, 1, 0));
+    LayerStats& stats = worker.stats.layer(layerNum);
+    size_t lpsNum = worker.engine.getLpsNum();
+    size_t exactLpsNum = worker.engine.getExactLpsNum();
+    double lpSeconds = worker.engine.getLpSeconds();
+    size_t learnedConflictsNum = worker.engine.getLearnedConflictsNum();
+    size_t conflictHitsNum = worker.engine.getConflictHitsNum();
+
+    bool feasible = worker.engine.isFeasible();
+
+    stats.feasibilityChecks++;
+    if ( feasible )
+        stats.feasibleChecks++;
+    else
+        stats.infeasibleChecks++;
 
-    soplex::DSVector row(neuralNetwork.at(0).size());
-    for ( size_t i = 0; i < boundData.size(); i++ )
+    if ( worker.engine.getLpsNum() != lpsNum )
     {
-        for ( size_t j = 1; j <= neuralNetwork.at(0).at(0).size()-1; j++ )
-            row.add(j-1, boundProtData.at(boundData.at(i).first).at(j));
-
-        if ( boundData.at(i).second == pwl2limodsat::GeqZero )
-            sop.addRowReal(soplex::LPRow(-boundProtData.at(boundData.at(i).first).at(0), row, soplex::infinity));
-        else if ( boundData.at(i).second == pwl2limodsat::LeqZero )
-            sop.addRowReal(soplex::LPRow(-soplex::infinity, row, -boundProtData.at(boundData.at(i).first).at(0)));
-
-        row.clear();
+        stats.feasibilityLps += worker.engine.getLpsNum() - lpsNum;
+        stats.feasibilityLpSeconds += worker.engine.getLpSeconds() - lpSeconds;
+        worker.lpsNum.fetch_add(worker.engine.getLpsNum() - lpsNum, std::memory_order_relaxed);
     }
 
-    sop.setIntParam(soplex::SoPlex::VERBOSITY, soplex::SoPlex::VERBOSITY_ERROR);
-    sop.setIntParam(soplex::SoPlex::OBJSENSE, soplex::SoPlex::OBJSENSE_MAXIMIZE);
-    sop.optimize();
-    float Max = sop.objValueReal();
+    stats.feasibilityExactLps += worker.engine.getExactLpsNum() - exactLpsNum;
+    stats.conflictsLearned += worker.engine.getLearnedConflictsNum() - learnedConflictsNum;
+    stats.conflictRejections += worker.engine.getConflictHitsNum() - conflictHitsNum;
+    worker.stats.updatePeakConflicts(worker.engine.getLiveConflictsNum());
 
-    if ( Max < 0 )
-        return false;
-    else
-        return true;
+    return feasible;
 }
 
-pwl2limodsat::BoundaryPrototypeCollection NeuralNetwork::composeBoundProtData(const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
-                                                                              unsigned layerNum)
+void NeuralNetwork::composeBoundProtData(const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
+                                         const std::vector<char>& activeInputs,
+                                         unsigned layerNum,
+                                         pwl2limodsat::BoundaryPrototypeCollection& newBoundProtData)
 {
-    pwl2limodsat::BoundaryPrototypeCollection newBoundProtData;
+    const FlatMatrix& weights = flatWeights.at(layerNum);
+    size_t coeffsNum = inputValues.at(0).size();
+
+    if ( weights.cols != inputValues.size() + 1 )
+        throw std::invalid_argument("Layer input size does not match the previous layer.");
 
-    for ( size_t i = 0; i < neuralNetwork.at(layerNum).size(); i++ )
+    newBoundProtData.resize(weights.rows);
+
+    // Each new prototype is the bias plus a weighted sum of the active input
+    // rows, accumulated row by row so the inner loop runs over contiguous memory
+    for ( size_t i = 0; i < weights.rows; i++ )
     {
-        pwl2limodsat::BoundaryPrototype auxBoundProt;
+        const double *weightRow = weights.row(i);
+        newBoundProtData[i].assign(coeffsNum, 0);
+        pwl2limodsat::BoundaryCoefficient *newBoundProt = newBoundProtData[i].data();
 
-        for ( size_t j = 0; j < inputValues.at(0).size(); j++ )
-        {
-            pwl2limodsat::BoundaryCoefficient auxCoeff;
+        newBoundProt[0] = weightRow[0];
 
-            if ( j == 0 )
-                auxCoeff = neuralNetwork.at(layerNum).at(i).at(0);
-            else
-                auxCoeff = 0;
+        for ( size_t k = 0; k < inputValues.size(); k++ )
+        {
+            if ( !activeInputs.empty() && !activeInputs[k] )
+                continue;
 
-            for ( size_t k = 0; k < inputValues.size(); k++ )
-                auxCoeff = auxCoeff + inputValues.at(k).at(j) * neuralNetwork.at(layerNum).at(i).at(k+1);
+            const double weight = weightRow[k+1];
+            const pwl2limodsat::BoundaryCoefficient *inputValue = inputValues[k].data();
 
-            auxBoundProt.push_back(auxCoeff);
+            for ( size_t j = 0; j < coeffsNum; j++ )
+                newBoundProt[j] += weight * inputValue[j];
         }
-
-        newBoundProtData.push_back(auxBoundProt);
     }
-
-    return newBoundProtData;
 }
 
 void NeuralNetwork::writeBoundProtData(pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
                                        const pwl2limodsat::BoundaryPrototypeCollection& newBoundProtData)
 {
-    for ( size_t i = 0; i < newBoundProtData.size(); i++ )
-    {
-        pwl2limodsat::BoundaryPrototype auxBoundProt;
-
-        for ( size_t j = 0; j < newBoundProtData.at(0).size(); j++ )
-        {
-            pwl2limodsat::BoundaryCoefficient auxCoeff;
-            auxCoeff = newBoundProtData.at(i).at(j);
-            auxBoundProt.push_back(auxCoeff);
-        }
-
-        boundProtData.push_back(auxBoundProt);
-    }
+    boundProtData.insert(boundProtData.end(), newBoundProtData.begin(), newBoundProtData.end());
 }
 
-pwl2limodsat::BoundaryPrototypeCollection NeuralNetwork::composeOutputValues(const pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
-                                                                             const std::vector<pwl2limodsat::BoundarySymbol>& iteration,
-                                                                             const std::vector<BoundProtPosition>& boundProtPositions)
+void NeuralNetwork::writeActiveNeurons(std::vector<char>& activeNeurons,
+                                       const std::vector<pwl2limodsat::BoundarySymbol>& iteration,
+                                       const std::vector<BoundProtPosition>& boundProtPositions)
 {
-    pwl2limodsat::BoundaryPrototypeCollection outputValues = boundProtData;
+    activeNeurons.assign(iteration.size(), 1);
 
     for ( size_t j = 0; j < iteration.size(); j++ )
     {
         if ( boundProtPositions.at(j) == Cutting )
         {
             if ( iteration.at(j) == pwl2limodsat::LeqZero )
-                for ( size_t k = 0; k < outputValues.at(0).size(); k++ )
-                    outputValues.at(j).at(k) = 0;
+                activeNeurons.at(j) = 0;
         }
         else if ( boundProtPositions.at(j) == Under )
-        {
-            for ( size_t k = 0; k < outputValues.at(0).size(); k++ )
-                outputValues.at(j).at(k) = 0;
-        }
+            activeNeurons.at(j) = 0;
     }
-
-    return outputValues;
 }
 
-void NeuralNetwork::writePwlData(pwl2limodsat::PiecewiseLinearFunctionData& pwlData,
-                                 const pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
+void NeuralNetwork::writePwlData(EnumerationWorker& worker,
+                                 size_t outIdx,
+                                 size_t regionNode,
                                  const pwl2limodsat::BoundaryPrototype& inputValues,
-                                 const pwl2limodsat::BoundaryCollection& currentBoundData,
                                  std::pair<pwl2limodsat::BoundProtIndex,pwl2limodsat::BoundProtIndex> newBoundProtIdx)
 {
-    pwl2limodsat::RegionalLinearPieceData rlp0;
-    rlp0.bound = currentBoundData;
-    rlp0.bound.push_back(pwl2limodsat::Boundary(newBoundProtIdx.first, pwl2limodsat::LeqZero));
-    if ( feasibleBounds(boundProtData, rlp0.bound) )
+    FeasibilityEngine& engine = worker.engine;
+    pwl2limodsat::RegionalLinearPieceData& region = worker.region;
+
+    engine.pushBoundary(worker.boundProtData, pwl2limodsat::Boundary(newBoundProtIdx.first, pwl2limodsat::LeqZero));
+    if ( checkFeasibility(worker, neuralNetwork.size() - 1) )
     {
-        for ( size_t i = 0; i < inputValues.size(); i++ )
-            rlp0.lpData.push_back(pwl2limodsat::LinearPieceCoefficient(0,1));
-        pwlData.push_back(rlp0);
+        region.bound.clear();
+        region.bound.push_back(pwl2limodsat::Boundary(newBoundProtIdx.first, pwl2limodsat::LeqZero));
+        region.lpData.assign(inputValues.size(), pwl2limodsat::LinearPieceCoefficient(0,1));
+        writeRegion(worker, outIdx, regionNode);
     }
+    engine.popBoundary();
 
-    pwl2limodsat::RegionalLinearPieceData rlp0_1;
-    rlp0_1.bound = currentBoundData;
-    rlp0_1.bound.push_back(pwl2limodsat::Boundary(newBoundProtIdx.first, pwl2limodsat::GeqZero));
-    rlp0_1.bound.push_back(pwl2limodsat::Boundary(newBoundProtIdx.second, pwl2limodsat::LeqZero));
-    if ( feasibleBounds(boundProtData, rlp0_1.bound) )
+    engine.pushBoundary(worker.boundProtData, pwl2limodsat::Boundary(newBoundProtIdx.first, pwl2limodsat::GeqZero));
+    engine.pushBoundary(worker.boundProtData, pwl2limodsat::Boundary(newBoundProtIdx.second, pwl2limodsat::LeqZero));
+    if ( checkFeasibility(worker, neuralNetwork.size() - 1) )
     {
+        region.bound.clear();
+        region.bound.push_back(pwl2limodsat::Boundary(newBoundProtIdx.first, pwl2limodsat::GeqZero));
+        region.bound.push_back(pwl2limodsat::Boundary(newBoundProtIdx.second, pwl2limodsat::LeqZero));
+        region.lpData.clear();
         for ( size_t i = 0; i < inputValues.size(); i++ )
-            rlp0_1.lpData.push_back(dec2frac(inputValues.at(i)));
-        pwlData.push_back(rlp0_1);
+            region.lpData.push_back(dec2frac(inputValues.at(i)));
+        writeRegion(worker, outIdx, regionNode);
+    }
+    engine.popBoundary();
+    engine.popBoundary();
+
+    engine.pushBoundary(worker.boundProtData, pwl2limodsat::Boundary(newBoundProtIdx.second, pwl2limodsat::GeqZero));
+    if ( checkFeasibility(worker, neuralNetwork.size() - 1) )
+    {
+        region.bound.clear();
+        region.bound.push_back(pwl2limodsat::Boundary(newBoundProtIdx.second, pwl2limodsat::GeqZero));
+        region.lpData.assign(inputValues.size(), pwl2limodsat::LinearPieceCoefficient(0,1));
+        region.lpData.at(0) = pwl2limodsat::LinearPieceCoefficient(1,1);
+        writeRegion(worker, outIdx, regionNode);
+    }
+    engine.popBoundary();
+}
+
+void NeuralNetwork::writeRegion(EnumerationWorker& worker, size_t outIdx, size_t regionNode)
+{
+    worker.stats.layer(neuralNetwork.size() - 1).regions++;
+    worker.piecesNum.fetch_add(1, std::memory_order_relaxed);
+
+    if ( !streaming )
+    {
+        worker.regions.addPiece(outIdx, regionNode, worker.region.lpData, worker.region.bound);
+        return;
+    }
+
+    PwlStreamChunk& chunk = worker.chunks.at(outIdx);
+
+    if ( worker.streamedProts.size() < worker.boundProtData.size() )
+    {
+        EnumerationWorker::StreamedPrototype unstreamed;
+        unstreamed.fileIdx.assign(nnOutputIndexes.size(), NoStreamIdx);
+        unstreamed.chunkSlot.assign(nnOutputIndexes.size(), NoStreamIdx);
+        worker.streamedProts.resize(worker.boundProtData.size(), unstreamed);
+    }
+
+    PendingRegion& pendingRegion = chunk.addRegion();
+    pendingRegion.lpData.assign(worker.region.lpData.begin(), worker.region.lpData.end());
+
+    for ( size_t i = 0; i < worker.boundStack.size() + worker.region.bound.size(); i++ )
+    {
+        const pwl2limodsat::Boundary& bound = ( i < worker.boundStack.size() ? worker.boundStack.at(i)
+                                                                            : worker.region.bound.at(i - worker.boundStack.size()) );
+        EnumerationWorker::StreamedPrototype& streamedProt = worker.streamedProts.at(bound.first);
+
+        if ( streamedProt.fileIdx.at(outIdx) != NoStreamIdx )
+        {
+            pendingRegion.bound.push_back(pwl2limodsat::Boundary(streamedProt.fileIdx.at(outIdx), bound.second));
+            pendingRegion.pooled.push_back(0);
+        }
+        else
+        {
+            if ( streamedProt.chunkSlot.at(outIdx) == NoStreamIdx )
+                streamedProt.chunkSlot.at(outIdx) = chunk.addBoundProt(worker.boundProtData.at(bound.first), bound.first);
+
+            pendingRegion.bound.push_back(pwl2limodsat::Boundary(streamedProt.chunkSlot.at(outIdx), bound.second));
+            pendingRegion.pooled.push_back(1);
+        }
     }
 
-    pwl2limodsat::RegionalLinearPieceData rlp1;
-    rlp1.bound = currentBoundData;
-    rlp1.bound.push_back(pwl2limodsat::Boundary(newBoundProtIdx.second, pwl2limodsat::GeqZero));
+    if ( chunk.regionsNum >= STREAM_CHUNK_SIZE )
+        flushChunk(worker, outIdx);
+}
+
+void NeuralNetwork::flushChunk(EnumerationWorker& worker, size_t outIdx)
+{
+    PwlStreamChunk& chunk = worker.chunks.at(outIdx);
+    std::vector<pwl2limodsat::BoundProtIndex> fileIdx;
+
+    if ( chunk.regionsNum == 0 )
+        return;
 
-    if ( feasibleBounds(boundProtData, rlp1.bound) )
+    pwlSinks.at(outIdx)->write(chunk, fileIdx);
+
+    for ( size_t slot = 0; slot < chunk.owners.size(); slot++ )
+        if ( chunk.owners.at(slot) != NoStreamIdx )
+        {
+            EnumerationWorker::StreamedPrototype& streamedProt = worker.streamedProts.at(chunk.owners.at(slot));
+            streamedProt.fileIdx.at(outIdx) = fileIdx.at(slot);
+            streamedProt.chunkSlot.at(outIdx) = NoStreamIdx;
+        }
+
+    chunk.clear();
+}
+
+// Drops the conflicts over the prototypes of a finished layer, which no
+// later region uses, and when streaming the prototypes themselves, so the
+// worker only holds those of the current search path
+void NeuralNetwork::truncateBoundProtData(EnumerationWorker& worker, pwl2limodsat::BoundProtIndex newSize)
+{
+    worker.engine.discardConflicts(newSize);
+
+    if ( !streaming || ( newSize >= worker.boundProtData.size() ) )
+        return;
+
+    // Entries of discarded prototypes are reset rather than removed, so the
+    // next layer reuses them
+    for ( size_t i = newSize; i < std::min(worker.streamedProts.size(), worker.boundProtData.size()); i++ )
     {
-        rlp1.lpData.push_back(pwl2limodsat::LinearPieceCoefficient(1,1));
-        for ( size_t i = 1; i < inputValues.size(); i++ )
-            rlp1.lpData.push_back(pwl2limodsat::LinearPieceCoefficient(0,1));
-        pwlData.push_back(rlp1);
+        EnumerationWorker::StreamedPrototype& streamedProt = worker.streamedProts.at(i);
+
+        for ( size_t outIdx = 0; outIdx < worker.chunks.size(); outIdx++ )
+            if ( streamedProt.chunkSlot.at(outIdx) != NoStreamIdx )
+                worker.chunks.at(outIdx).owners.at(streamedProt.chunkSlot.at(outIdx)) = NoStreamIdx;
+
+        std::fill(streamedProt.fileIdx.begin(), streamedProt.fileIdx.end(), NoStreamIdx);
+        std::fill(streamedProt.chunkSlot.begin(), streamedProt.chunkSlot.end(), NoStreamIdx);
     }
+
+    worker.boundProtData.resize(newSize);
 }
 
-bool NeuralNetwork::iterate(size_t limitIterationIdx,
-                            std::vector<pwl2limodsat::BoundarySymbol>& iteration,
+// Moves to the next activation pattern, leaving the signs before
+// firstIterationIdx as they are
+bool NeuralNetwork::iterate(std::vector<pwl2limodsat::BoundarySymbol>& iteration,
                             size_t& currentIterationIdx,
+                            size_t firstIterationIdx,
                             const std::vector<BoundProtPosition>& boundProtPositions,
-                            pwl2limodsat::BoundaryCollection& boundData)
+                            pwl2limodsat::BoundaryCollection& boundData,
+                            FeasibilityEngine& engine)
 {
     bool iterating = true;
 
+    if ( currentIterationIdx < firstIterationIdx )
+        return false;
+
     while ( iterating )
     {
         if ( boundProtPositions.at(currentIterationIdx) == Cutting )
+        {
             boundData.pop_back();
+            engine.popBoundary();
+        }
 
         if ( ( boundProtPositions.at(currentIterationIdx) == Cutting ) &&
              ( iteration.at(currentIterationIdx) == pwl2limodsat::GeqZero ) )
@@ -302,7 +478,7 @@ bool NeuralNetwork::iterate(size_t limitIterationIdx,
         else
         {
             iteration.at(currentIterationIdx) = pwl2limodsat::GeqZero;
-            if ( currentIterationIdx > limitIterationIdx )
+            if ( currentIterationIdx > firstIterationIdx )
                 currentIterationIdx--;
             else
                 return false;
@@ -312,55 +488,111 @@ bool NeuralNetwork::iterate(size_t limitIterationIdx,
     return true;
 }
 
-bool NeuralNetwork::iterate(std::vector<pwl2limodsat::BoundarySymbol>& iteration,
-                            size_t& currentIterationIdx,
-                            const std::vector<BoundProtPosition>& boundProtPositions,
-                            pwl2limodsat::BoundaryCollection& boundData)
-{
-    return iterate(0, iteration, currentIterationIdx, boundProtPositions, boundData);
-}
-
-void NeuralNetwork::net2pwl(pwl2limodsat::BoundaryPrototypeCollection& boundProtData,
-                            std::vector<pwl2limodsat::PiecewiseLinearFunctionData>& pwlData,
+void NeuralNetwork::net2pwl(EnumerationWorker& worker,
                             const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
-                            const pwl2limodsat::BoundaryCollection& currentBoundData,
+                            const std::vector<char>& activeInputs,
+                            size_t parentNode,
                             size_t layerNum)
 {
-    pwl2limodsat::BoundaryPrototypeCollection newBoundProtData;
+    pwl2limodsat::BoundaryPrototypeCollection& boundProtData = worker.boundProtData;
+    pwl2limodsat::BoundaryCollection& boundStack = worker.boundStack;
+    FeasibilityEngine& engine = worker.engine;
+
+    EnumerationWorker::LayerScratch& scratch = worker.scratch.at(layerNum);
+    pwl2limodsat::BoundaryPrototypeCollection& newBoundProtData = scratch.boundProtData;
 
     if ( layerNum == 0 )
         newBoundProtData = inputValues;
     else
-        newBoundProtData = composeBoundProtData(inputValues, layerNum);
+        composeBoundProtData(inputValues, activeInputs, layerNum, newBoundProtData);
 
     pwl2limodsat::BoundProtIndex newBoundProtDataFirstIdx = boundProtData.size();
     writeBoundProtData(boundProtData, newBoundProtData);
 
     if ( layerNum + 1 == neuralNetwork.size() )
     {
+        worker.progressed = true;
+
         for ( size_t outIdx = 0; outIdx < nnOutputIndexes.size(); outIdx++ )
         {
             boundProtData.push_back( boundProtData.at(newBoundProtDataFirstIdx+nnOutputIndexes.at(outIdx)) );
             boundProtData.back().at(0) = boundProtData.back().at(0) - 1;
-            writePwlData( pwlData.at(outIdx),
-                          boundProtData,
+            writePwlData( worker,
+                          outIdx,
+                          parentNode,
                           newBoundProtData.at( nnOutputIndexes.at(outIdx) ),
-                          currentBoundData,
                           std::pair<pwl2limodsat::BoundProtIndex, pwl2limodsat::BoundProtIndex>(newBoundProtDataFirstIdx + nnOutputIndexes.at(outIdx),
                                                                                                 boundProtData.size() - 1) );
         }
     }
     else
     {
-        std::vector<BoundProtPosition> boundProtPositions;
-        std::vector<pwl2limodsat::BoundarySymbol> iteration(newBoundProtData.size(), pwl2limodsat::GeqZero);
+        std::vector<BoundProtPosition>& boundProtPositions = scratch.boundProtPositions;
+        std::vector<pwl2limodsat::BoundarySymbol>& iteration = scratch.iteration;
+
+        boundProtPositions.clear();
+        iteration.assign(newBoundProtData.size(), pwl2limodsat::GeqZero);
 
         for ( size_t i = newBoundProtDataFirstIdx; i < newBoundProtDataFirstIdx + newBoundProtData.size(); i++ )
-            boundProtPositions.push_back( boundProtPosition(boundProtData, i) );
+            boundProtPositions.push_back( boundProtPosition(boundProtData, i, worker.stats.layer(layerNum)) );
+
+        size_t cuttingNeuronsNum = 0;
+        scratch.cuttingNeurons.assign(boundProtPositions.size(), 0);
+        for ( size_t i = 0; i < boundProtPositions.size(); i++ )
+            if ( boundProtPositions.at(i) == Cutting )
+            {
+                scratch.cuttingNeurons.at(i) = 1;
+                cuttingNeuronsNum++;
+            }
 
         size_t currentIterationIdx = 0;
+        size_t layerStackBase = boundStack.size();
         bool iterated = true;
-        pwl2limodsat::BoundaryCollection auxCurrentBoundData = currentBoundData;
+
+        // A task split off within this layer only explores the patterns
+        // starting with the signs it fixes
+        std::vector<pwl2limodsat::BoundarySymbol> prefix;
+        prefix.swap(worker.taskPrefix);
+
+        if ( prefix.size() > iteration.size() )
+            throw std::invalid_argument("Checkpoint does not match the neural network.");
+
+        size_t firstIterationIdx = prefix.size();
+
+        // Restart from the pattern being explored when the task was suspended
+        if ( !worker.resumeIterations.at(layerNum).empty() )
+        {
+            if ( worker.resumeIterations.at(layerNum).size() != iteration.size() )
+                throw std::invalid_argument("Checkpoint does not match the neural network.");
+
+            iteration.swap(worker.resumeIterations.at(layerNum));
+            worker.resumeIterations.at(layerNum).clear();
+
+            for ( size_t i = 0; i < iteration.size(); i++ )
+                if ( boundProtPositions.at(i) == Cutting )
+                {
+                    boundStack.push_back( pwl2limodsat::Boundary(newBoundProtDataFirstIdx + i, iteration.at(i)) );
+                    engine.pushBoundary(boundProtData, boundStack.back());
+                    checkFeasibility(worker, layerNum);
+                }
+                else
+                    iteration.at(i) = pwl2limodsat::GeqZero;
+
+            currentIterationIdx = iteration.size();
+        }
+        else if ( !prefix.empty() )
+        {
+            for ( size_t i = 0; i < prefix.size(); i++ )
+                if ( boundProtPositions.at(i) == Cutting )
+                {
+                    iteration.at(i) = prefix.at(i);
+                    boundStack.push_back( pwl2limodsat::Boundary(newBoundProtDataFirstIdx + i, iteration.at(i)) );
+                    engine.pushBoundary(boundProtData, boundStack.back());
+                }
+
+            iterated = checkFeasibility(worker, layerNum);
+            currentIterationIdx = prefix.size();
+        }
 
         while ( iterated )
         {
@@ -370,219 +602,489 @@ void NeuralNetwork::net2pwl(pwl2limodsat::BoundaryPrototypeCollection& boundProt
                     currentIterationIdx++;
                 else
                 {
-                    if ( iteration.at(currentIterationIdx) == pwl2limodsat::GeqZero )
-                        auxCurrentBoundData.push_back( pwl2limodsat::Boundary(newBoundProtDataFirstIdx + currentIterationIdx,
-                                                                              pwl2limodsat::GeqZero) );
-                    else
-                        auxCurrentBoundData.push_back( pwl2limodsat::Boundary(newBoundProtDataFirstIdx + currentIterationIdx,
-                                                                              pwl2limodsat::LeqZero) );
-
-                    if ( feasibleBounds(boundProtData, auxCurrentBoundData) )
+                    // Hand the patterns with this neuron active over to an
+                    // idle worker and go on with those where it is inactive
+                    if ( ( iteration.at(currentIterationIdx) == pwl2limodsat::GeqZero ) &&
+                         ( worker.scheduler != nullptr ) &&
+                         worker.scheduler->hasHungryWorkers() )
+                    {
+                        splitTask(worker, inputValues, activeInputs, layerNum, layerStackBase, iteration, currentIterationIdx+1);
+                        iteration.at(currentIterationIdx) = pwl2limodsat::LeqZero;
+                    }
+
+                    boundStack.push_back( pwl2limodsat::Boundary(newBoundProtDataFirstIdx + currentIterationIdx,
+                                                                 iteration.at(currentIterationIdx)) );
+
+                    engine.pushBoundary(boundProtData, boundStack.back());
+
+                    if ( checkFeasibility(worker, layerNum) )
                         currentIterationIdx++;
                     else
-                        iterated = iterate(iteration, currentIterationIdx, boundProtPositions, auxCurrentBoundData);
+                        iterated = iterate(iteration, currentIterationIdx, firstIterationIdx, boundProtPositions, boundStack, engine);
                 }
             }
 
             if ( iterated )
             {
-                pwl2limodsat::BoundaryPrototypeCollection outputValues = composeOutputValues(newBoundProtData,
-                                                                                             iteration,
-                                                                                             boundProtPositions);
+                writeActiveNeurons(scratch.activeNeurons, iteration, boundProtPositions);
+
+                // A subtree being resumed is entered here, the patterns it
+                // already explored are only known to this worker
+                bool resuming = !worker.resumeIterations.at(layerNum+1).empty();
+
+                // Leave this subtree and the rest of the search to a checkpoint
+                if ( !resuming && worker.progressed && checkpointDue() )
+                    worker.suspended = true;
+                // Hand the subtree over to an idle worker instead of exploring it here
+                else if ( !resuming &&
+                          ( worker.scheduler != nullptr ) &&
+                          ( layerNum + 2 < neuralNetwork.size() ) &&
+                          worker.scheduler->hasHungryWorkers() )
+                    splitTask(worker, newBoundProtData, scratch.activeNeurons, layerNum+1, boundStack.size(), iteration, 0);
+                else if ( streaming || ( cuttingNeuronsNum == 0 ) )
+                    net2pwl(worker, newBoundProtData, scratch.activeNeurons, parentNode, layerNum+1);
+                else
+                    net2pwl(worker,
+                            newBoundProtData,
+                            scratch.activeNeurons,
+                            worker.regions.addNode(parentNode, newBoundProtDataFirstIdx, scratch.cuttingNeurons, iteration),
+                            layerNum+1);
+
+                if ( worker.suspended )
+                {
+                    worker.suspendedIterations.push_back(iteration);
+                    break;
+                }
 
-                net2pwl(boundProtData, pwlData, outputValues, auxCurrentBoundData, layerNum+1);
+                worker.stats.layer(layerNum).regions++;
 
                 currentIterationIdx--;
-                iterated = iterate(iteration, currentIterationIdx, boundProtPositions, auxCurrentBoundData);
+                iterated = iterate(iteration, currentIterationIdx, firstIterationIdx, boundProtPositions, boundStack, engine);
             }
         }
+
+        // The signs fixed by the task are left to the end of the layer
+        if ( !worker.suspended )
+            for ( size_t i = 0; i < prefix.size(); i++ )
+                if ( boundProtPositions.at(i) == Cutting )
+                {
+                    boundStack.pop_back();
+                    engine.popBoundary();
+                }
     }
+
+    worker.stats.updatePeakBoundProtData(boundProtData.size());
+    truncateBoundProtData(worker, newBoundProtDataFirstIdx);
 }
 
-void NeuralNetwork::net2pwl(const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
-                            const pwl2limodsat::BoundaryCollection& currentBoundData,
-                            size_t layerNum)
+// Hands the patterns of layer layerNum starting with the first prefixSize
+// signs of iteration over to the scheduler, under the first boundsNum
+// boundaries of the worker's stack
+void NeuralNetwork::splitTask(EnumerationWorker& worker,
+                              const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
+                              const std::vector<char>& activeInputs,
+                              size_t layerNum,
+                              size_t boundsNum,
+                              const std::vector<pwl2limodsat::BoundarySymbol>& iteration,
+                              size_t prefixSize)
 {
-    net2pwl(boundProtData, pwlData, inputValues, currentBoundData, layerNum);
+    EnumerationTask task;
+    task.layerNum = layerNum;
+    task.inputValues = inputValues;
+    task.prefix.assign(iteration.begin(), iteration.begin() + prefixSize);
+
+    for ( size_t k = 0; k < task.inputValues.size(); k++ )
+        if ( !activeInputs.empty() && !activeInputs.at(k) )
+            task.inputValues.at(k).assign(task.inputValues.at(k).size(), 0);
+
+    for ( size_t i = 0; i < boundsNum; i++ )
+    {
+        task.boundProtData.push_back(worker.boundProtData.at(worker.boundStack.at(i).first));
+        task.boundData.push_back(pwl2limodsat::Boundary(i, worker.boundStack.at(i).second));
+    }
+
+    worker.scheduler->push(worker.id, std::move(task));
 }
 
-std::pair<std::vector<pwl2limodsat::PiecewiseLinearFunctionData>,
-          pwl2limodsat::BoundaryPrototypeCollection> NeuralNetwork::partialNet2pwl(unsigned startingPoint,
-                                                                                   size_t fixedNodesNum,
-                                                                                   const pwl2limodsat::BoundaryPrototypeCollection& inputValues,
-                                                                                   const std::vector<BoundProtPosition>& boundProtPositions)
+void NeuralNetwork::runTask(EnumerationWorker& worker, const EnumerationTask& task)
 {
-    pwl2limodsat::BoundaryPrototypeCollection localBoundProtData;
-    std::vector<pwl2limodsat::PiecewiseLinearFunctionData> localPwlData;
-    pwl2limodsat::BoundaryPrototypeCollection newBoundProtData = inputValues;
+    pwl2limodsat::BoundProtIndex taskFirstIdx = worker.boundProtData.size();
+
+    worker.boundProtData.insert(worker.boundProtData.end(), task.boundProtData.begin(), task.boundProtData.end());
+    worker.boundStack.clear();
+    worker.engine.clear();
 
-    for ( unsigned outIdx = 0; outIdx < nnOutputIndexes.size(); outIdx++ )
+    std::vector<pwl2limodsat::BoundarySymbol> taskSymbols;
+
+    for ( const pwl2limodsat::Boundary& bound : task.boundData )
     {
-        pwl2limodsat::PiecewiseLinearFunctionData emptyPwlData;
-        localPwlData.push_back(emptyPwlData);
+        worker.boundStack.push_back(pwl2limodsat::Boundary(taskFirstIdx + bound.first, bound.second));
+        worker.engine.pushBoundary(worker.boundProtData, worker.boundStack.back());
+        taskSymbols.push_back(bound.second);
     }
 
-    writeBoundProtData(localBoundProtData, newBoundProtData);
+    // The boundaries a task starts from become the root of its regions
+    size_t taskNode = NoRegionNode;
+    if ( !streaming && !task.boundData.empty() )
+        taskNode = worker.regions.addNode(NoRegionNode, taskFirstIdx, std::vector<char>(taskSymbols.size(), 1), taskSymbols);
+
+    worker.stats.taskRun();
+
+    worker.progressed = false;
+    worker.suspended = false;
+    worker.suspendedIterations.clear();
+    for ( std::vector<pwl2limodsat::BoundarySymbol>& iteration : worker.resumeIterations )
+        iteration.clear();
+    for ( size_t k = 0; k < task.resumeIterations.size(); k++ )
+        worker.resumeIterations.at(task.layerNum + k) = task.resumeIterations.at(k);
+    worker.taskPrefix = task.prefix;
 
-    pwl2limodsat::BoundaryCollection auxCurrentBoundData;
-    std::vector<pwl2limodsat::BoundarySymbol> iteration;
+    net2pwl(worker, task.inputValues, std::vector<char>(), taskNode, task.layerNum);
 
-    size_t fixedNodesIt = 0, fixedNodes = 0;
-    while ( fixedNodes < fixedNodesNum )
+    truncateBoundProtData(worker, taskFirstIdx);
+
+    if ( worker.suspended )
     {
-        if ( boundProtPositions.at(fixedNodesIt) != Cutting )
-            iteration.push_back(pwl2limodsat::GeqZero);
-        else
-        {
-            if ( ( ( startingPoint >> fixedNodes ) & 1 ) == 0 )
-                iteration.push_back( pwl2limodsat::GeqZero );
-            else
-                iteration.push_back( pwl2limodsat::LeqZero );
+        EnumerationTask remainingTask;
+        remainingTask.layerNum = task.layerNum;
+        remainingTask.inputValues = task.inputValues;
+        remainingTask.boundProtData = task.boundProtData;
+        remainingTask.boundData = task.boundData;
+        remainingTask.prefix = task.prefix;
+        remainingTask.resumeIterations.assign(worker.suspendedIterations.rbegin(), worker.suspendedIterations.rend());
+
+        worker.suspendedTasks.push_back(std::move(remainingTask));
+
+        if ( worker.scheduler != nullptr )
+            worker.scheduler->suspend();
+    }
+}
 
-            if ( iteration.back() == pwl2limodsat::GeqZero )
-                auxCurrentBoundData.push_back( pwl2limodsat::Boundary(iteration.size() - 1, pwl2limodsat::GeqZero) );
-            else
-                auxCurrentBoundData.push_back( pwl2limodsat::Boundary(iteration.size() - 1, pwl2limodsat::LeqZero) );
+void NeuralNetwork::runWorker(EnumerationWorker *worker)
+{
+    EnumerationTask task;
 
-            fixedNodes++;
+    try
+    {
+        while ( worker->scheduler->pop(worker->id, task) )
+        {
+            runTask(*worker, task);
+            worker->scheduler->taskDone();
         }
-        fixedNodesIt++;
     }
+    catch ( ... )
+    {
+        worker->scheduler->abort();
+        throw;
+    }
+}
+
+void NeuralNetwork::pwlInfoMerge(const std::vector<std::unique_ptr<EnumerationWorker>>& workers)
+{
+    for ( size_t i = 0; i < workers.size(); i++ )
+    {
+        pwl2limodsat::BoundProtIndex boundProtDataCurrentSize = boundProtData.size();
+        boundProtData.insert(boundProtData.end(),
+                             workers.at(i)->boundProtData.begin(),
+                             workers.at(i)->boundProtData.end());
+
+        regionStore.append(workers.at(i)->regions, boundProtDataCurrentSize);
+    }
+}
+
+// Keeps only the prototypes some region uses, each distinct hyperplane once
+void NeuralNetwork::compactBoundProtData()
+{
+    std::vector<char> referenced(boundProtData.size(), 0);
+    regionStore.markReferenced(referenced);
+
+    BoundaryPrototypeTable boundProtTable(PROTOTYPE_TOLERANCE);
+    std::vector<pwl2limodsat::Boundary> remap(boundProtData.size(), pwl2limodsat::Boundary(0, pwl2limodsat::GeqZero));
+
+    for ( size_t i = 0; i < boundProtData.size(); i++ )
+        if ( referenced.at(i) )
+            remap.at(i) = boundProtTable.intern(boundProtData.at(i));
+
+    boundProtData = boundProtTable.getBoundProtData();
+    regionStore.setBoundaryRemap(std::move(remap));
+}
+
+// Runs the tasks until they are done or a checkpoint is due; in the latter
+// case tasks is left with the work still to be done
+void NeuralNetwork::runTasks(const std::vector<std::unique_ptr<EnumerationWorker>>& workers, std::vector<EnumerationTask>& tasks)
+{
+    std::vector<EnumerationTask> remainingTasks;
+
+    if ( processingMode == Multi )
+    {
+        EnumerationScheduler scheduler(workers.size());
+
+        for ( size_t i = 0; i < workers.size(); i++ )
+            workers.at(i)->scheduler = &scheduler;
 
-    size_t minIterationIdx = iteration.size();
-    size_t currentIterationIdx = minIterationIdx;
+        for ( size_t i = 0; i < tasks.size(); i++ )
+            scheduler.push(i % workers.size(), std::move(tasks.at(i)));
 
-    for ( size_t i = 0; i < boundProtPositions.size() - fixedNodesIt; i++ )
-        iteration.push_back(pwl2limodsat::GeqZero);
+        std::vector<std::future<void>> workersFut;
+        for ( unsigned i = 0; i < workers.size(); i++ )
+            workersFut.push_back( async(std::launch::async, &NeuralNetwork::runWorker, this, workers.at(i).get()) );
 
-    bool iterated = true;
+        for ( size_t i = 0; i < workersFut.size(); i++ )
+            workersFut.at(i).get();
 
-    while ( iterated )
+        scheduler.drain(remainingTasks);
+
+        for ( size_t i = 0; i < workers.size(); i++ )
+            workers.at(i)->scheduler = nullptr;
+    }
+    else if ( processingMode == Single )
     {
-        while ( ( iterated ) && ( currentIterationIdx < iteration.size() ) )
+        for ( size_t i = 0; i < tasks.size(); i++ )
         {
-            if ( boundProtPositions.at(currentIterationIdx) != Cutting )
-                currentIterationIdx++;
+            if ( ( i > 0 ) && checkpointDue() )
+                remainingTasks.push_back(std::move(tasks.at(i)));
             else
-            {
-                if ( iteration.at(currentIterationIdx) == pwl2limodsat::GeqZero )
-                    auxCurrentBoundData.push_back( pwl2limodsat::Boundary(currentIterationIdx, pwl2limodsat::GeqZero) );
-                else
-                    auxCurrentBoundData.push_back( pwl2limodsat::Boundary(currentIterationIdx, pwl2limodsat::LeqZero) );
-
-                if ( feasibleBounds(boundProtData, auxCurrentBoundData) )
-                    currentIterationIdx++;
-                else
-                    iterated = iterate(minIterationIdx, iteration, currentIterationIdx, boundProtPositions, auxCurrentBoundData);
-            }
+                runTask(*workers.front(), tasks.at(i));
         }
+    }
 
-        if ( iterated )
-        {
-            pwl2limodsat::BoundaryPrototypeCollection outputValues = composeOutputValues(newBoundProtData,
-                                                                                         iteration,
-                                                                                         boundProtPositions);
-
-            net2pwl(localBoundProtData, localPwlData, outputValues, auxCurrentBoundData, 1);
+    for ( size_t i = 0; i < workers.size(); i++ )
+    {
+        for ( EnumerationTask& task : workers.at(i)->suspendedTasks )
+            remainingTasks.push_back(std::move(task));
 
-            currentIterationIdx--;
-            iterated = iterate(minIterationIdx, iteration, currentIterationIdx, boundProtPositions, auxCurrentBoundData);
-        }
+        workers.at(i)->suspendedTasks.clear();
     }
 
-    return std::pair<std::vector<pwl2limodsat::PiecewiseLinearFunctionData>,
-                     pwl2limodsat::BoundaryPrototypeCollection>(localPwlData, localBoundProtData);
+    tasks.swap(remainingTasks);
 }
 
-void NeuralNetwork::pwlInfoMerge(const std::vector<std::pair<std::vector<pwl2limodsat::PiecewiseLinearFunctionData>,
-                                                             pwl2limodsat::BoundaryPrototypeCollection>>& threadsInfo)
+void NeuralNetwork::writeCheckpoint(const std::vector<std::unique_ptr<EnumerationWorker>>& workers, const std::vector<EnumerationTask>& tasks)
 {
-    unsigned boundProtDataInitialSize = boundProtData.size();
-    for ( size_t i = 0; i < threadsInfo.size(); i++ )
-    {
-        unsigned boundProtDataCurrentSize = boundProtData.size();
-        boundProtData.insert(boundProtData.end(),
-                             threadsInfo.at(i).second.begin() + boundProtDataInitialSize,
-                             threadsInfo.at(i).second.end());
+    EnumerationCheckpoint checkpoint(neuralNetwork, nnOutputIndexes, inputDomain, exact);
+
+    checkpoint.addRegions(regionStore, boundProtData);
+    for ( size_t i = 0; i < workers.size(); i++ )
+        checkpoint.addRegions(workers.at(i)->regions, workers.at(i)->boundProtData);
+
+    for ( const EnumerationTask& task : tasks )
+        checkpoint.addTask(task);
+
+    checkpoint.write(checkpointFileName);
+}
+
+// Regions of the checkpoint go straight to the final store. Its prototypes
+// are appended once and every region lists the ones it uses, so
+// compactBoundProtData merges them with those found after resuming.
+void NeuralNetwork::loadCheckpoint(std::vector<EnumerationTask>& tasks)
+{
+    EnumerationCheckpoint checkpoint(neuralNetwork, nnOutputIndexes, inputDomain, exact);
+    checkpoint.read(checkpointFileName);
+
+    pwl2limodsat::BoundProtIndex firstIdx = boundProtData.size();
+    boundProtData.insert(boundProtData.end(), checkpoint.getBoundProtData().begin(), checkpoint.getBoundProtData().end());
 
+    pwl2limodsat::BoundaryCollection nodeBound, tail;
 
-        for ( size_t j = 0; j < threadsInfo.at(i).first.size(); j++ )
+    for ( size_t outIdx = 0; outIdx < nnOutputIndexes.size(); outIdx++ )
+        for ( const pwl2limodsat::RegionalLinearPieceData& rlpData : checkpoint.getPwlData(outIdx) )
         {
-            for ( size_t k = 0; k < threadsInfo.at(i).first.at(j).size(); k++ )
+            size_t nodeWidth = rlpData.bound.size() - std::min(rlpData.bound.size(), (size_t) 2);
+
+            nodeBound.clear();
+            tail.clear();
+
+            for ( size_t i = 0; i < rlpData.bound.size(); i++ )
             {
-                pwlData.at(j).push_back(threadsInfo.at(i).first.at(j).at(k));
+                pwl2limodsat::Boundary bound(firstIdx + rlpData.bound.at(i).first, rlpData.bound.at(i).second);
 
-                if ( i > 0 )
-                {
-                    for ( size_t l = 0; l < pwlData.at(j).back().bound.size(); l++ )
-                        if ( pwlData.at(j).back().bound.at(l).first >= boundProtDataInitialSize )
-                        {
-                            pwlData.at(j).back().bound.at(l).first += boundProtDataCurrentSize;
-                            pwlData.at(j).back().bound.at(l).first -= boundProtDataInitialSize;
-                        }
-                }
+                if ( i < nodeWidth )
+                    nodeBound.push_back(bound);
+                else
+                    tail.push_back(bound);
             }
+
+            size_t regionNode = NoRegionNode;
+            if ( nodeWidth > 0 )
+                regionNode = regionStore.addNode(NoRegionNode, nodeBound);
+
+            regionStore.addPiece(outIdx, regionNode, rlpData.lpData, tail);
         }
+
+    tasks.swap(checkpoint.getTasks());
+}
+
+void NeuralNetwork::reportProgress(const std::vector<std::unique_ptr<EnumerationWorker>>& workers, std::future<void> enumerationDone)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    while ( enumerationDone.wait_for(progressInterval) == std::future_status::timeout )
+    {
+        size_t piecesNum = 0, lpsNum = 0;
+
+        for ( size_t i = 0; i < workers.size(); i++ )
+        {
+            piecesNum += workers.at(i)->piecesNum.load(std::memory_order_relaxed);
+            lpsNum += workers.at(i)->lpsNum.load(std::memory_order_relaxed);
+        }
+
+        std::cout << "progress: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s, "
+                  << piecesNum << " pieces, " << lpsNum << " feasibility LPs" << std::endl;
     }
 }
 
-void NeuralNetwork::net2pwlMultithreading(const pwl2limodsat::BoundaryPrototypeCollection& inputValues)
+void NeuralNetwork::printStatsFile()
 {
-    pwl2limodsat::BoundaryPrototypeCollection newBoundProtData = inputValues;
-    std::vector<BoundProtPosition> boundProtPositions;
+    if ( workerStats.empty() )
+        net2pwl();
 
-    writeBoundProtData(boundProtData, newBoundProtData);
+    std::ofstream statsFile(statsFileName);
 
-    for ( size_t i = 0; i < newBoundProtData.size(); i++ )
-        boundProtPositions.push_back( boundProtPosition(boundProtData, i) );
+    if ( !statsFile.is_open() )
+        throw std::invalid_argument("Unable to open stats file.");
 
-    unsigned cuttingNodes = 0;
-    for ( size_t i = 0; i < boundProtPositions.size(); i++ )
-        if ( boundProtPositions.at(i) == Cutting )
-            cuttingNodes++;
+    EnumerationStats totalStats(neuralNetwork.size());
+    for ( const EnumerationStats& stats : workerStats )
+        totalStats.add(stats);
 
-    size_t fixedNodesMax = floor(log2(std::thread::hardware_concurrency()));
-    size_t fixedNodes = ( cuttingNodes > fixedNodesMax ? fixedNodesMax : cuttingNodes );
-    unsigned threadsNum = pow(2, fixedNodes);
+    statsFile << "{\n";
+    statsFile << "  \"enumerationSeconds\": " << enumerationSeconds << ",\n";
+    statsFile << "  \"total\": ";
+    totalStats.writeJson(statsFile, "  ");
+    statsFile << ",\n  \"workers\": [";
 
-    std::vector<std::future<std::pair<std::vector<pwl2limodsat::PiecewiseLinearFunctionData>,
-                                      pwl2limodsat::BoundaryPrototypeCollection>>> threadsInfoFut;
-    for ( unsigned i = 0; i < threadsNum; i++ )
-        threadsInfoFut.push_back( async(&NeuralNetwork::partialNet2pwl, this, i, fixedNodes, inputValues, boundProtPositions) );
+    for ( size_t i = 0; i < workerStats.size(); i++ )
+    {
+        statsFile << ( i == 0 ? "\n    " : ",\n    " );
+        workerStats.at(i).writeJson(statsFile, "    ");
+    }
 
-    std::vector<std::pair<std::vector<pwl2limodsat::PiecewiseLinearFunctionData>,
-                          pwl2limodsat::BoundaryPrototypeCollection>> threadsInfo;
-    for ( size_t i = 0; i < threadsInfoFut.size(); i++ )
-        threadsInfo.push_back(threadsInfoFut.at(i).get());
+    statsFile << "\n  ]\n}\n";
+}
 
-    pwlInfoMerge(threadsInfo);
+void NeuralNetwork::setInputDomain(const InputDomain& domain)
+{
+    if ( domain.getDimension() != getInputDimension() )
+        throw std::invalid_argument("Input domain and neural network input dimensions differ.");
+
+    if ( pwlTranslation )
+        throw std::logic_error("Input domain set after the regions were enumerated.");
+
+    inputDomain = domain;
+}
+
+void NeuralNetwork::setExact(bool exactDecisions)
+{
+    if ( pwlTranslation )
+        throw std::logic_error("Exact decisions set after the regions were enumerated.");
+
+    exact = exactDecisions;
+}
+
+void NeuralNetwork::setInputLimits(const std::map<unsigned,std::pair<double,double>>& inputLimits)
+{
+    InputDomain domain(inputDomain);
+    domain.setLimits(inputLimits);
+    setInputDomain(domain);
+}
+
+void NeuralNetwork::setCheckpoint(unsigned intervalSeconds)
+{
+    checkpointInterval = std::chrono::seconds(intervalSeconds);
+    checkpointing = true;
 }
 
 void NeuralNetwork::net2pwl()
 {
-    pwl2limodsat::BoundaryPrototypeCollection firstInputValues;
+    std::vector<EnumerationTask> tasks;
 
-    for ( size_t i = 0; i < neuralNetwork.at(0).size(); i++ )
+    if ( ( checkpointing || resuming ) && streaming )
+        throw std::invalid_argument("Streamed pwl files cannot be checkpointed.");
+
+    if ( resuming )
+        loadCheckpoint(tasks);
+    else
     {
-        pwl2limodsat::BoundaryPrototype auxFirstInputValues;
+        EnumerationTask firstTask;
+
+        for ( size_t i = 0; i < neuralNetwork.at(0).size(); i++ )
+        {
+            pwl2limodsat::BoundaryPrototype auxFirstInputValues;
 
-        for ( size_t j = 0; j < neuralNetwork.at(0).at(0).size(); j++ )
-            auxFirstInputValues.push_back(neuralNetwork.at(0).at(i).at(j));
+            for ( size_t j = 0; j < neuralNetwork.at(0).at(0).size(); j++ )
+                auxFirstInputValues.push_back(neuralNetwork.at(0).at(i).at(j));
 
-        firstInputValues.push_back(auxFirstInputValues);
+            firstTask.inputValues.push_back(auxFirstInputValues);
+        }
+
+        tasks.push_back(std::move(firstTask));
     }
 
+    unsigned workersNum = 1;
     if ( processingMode == Multi )
+        workersNum = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::unique_ptr<EnumerationWorker>> workers;
+    for ( unsigned i = 0; i < workersNum; i++ )
     {
-        net2pwlMultithreading(firstInputValues);
+        workers.push_back(std::unique_ptr<EnumerationWorker>(new EnumerationWorker(i,
+                                                                                   neuralNetwork.size(),
+                                                                                   inputDomain,
+                                                                                   exact,
+                                                                                   nnOutputIndexes.size(),
+                                                                                   nullptr)));
+
+        if ( maxConflicts > 0 )
+            workers.back()->engine.setMaxConflicts(maxConflicts);
     }
-    else if ( processingMode == Single )
+
+    std::chrono::steady_clock::time_point enumerationStart = std::chrono::steady_clock::now();
+
+    // The reporter is declared first so it is joined after the promise is
+    // released, also when the enumeration throws
+    std::future<void> reporterFut;
+    std::promise<void> enumerationDone;
+    if ( progressInterval.count() > 0 )
+        reporterFut = async(std::launch::async,
+                            &NeuralNetwork::reportProgress,
+                            this,
+                            std::cref(workers),
+                            enumerationDone.get_future());
+
+    while ( !tasks.empty() )
     {
-        pwl2limodsat::BoundaryCollection emptyBounds;
-        net2pwl(firstInputValues, emptyBounds, 0);
+        checkpointDeadline = std::chrono::steady_clock::now() + checkpointInterval;
+        runTasks(workers, tasks);
+
+        if ( !tasks.empty() )
+            writeCheckpoint(workers, tasks);
     }
 
-    pwlTranslation = true;
+    enumerationDone.set_value();
+    if ( reporterFut.valid() )
+        reporterFut.get();
+
+    enumerationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - enumerationStart).count();
+    workerStats.clear();
+    for ( size_t i = 0; i < workers.size(); i++ )
+        workerStats.push_back(workers.at(i)->stats);
+
+    if ( streaming )
+    {
+        for ( size_t i = 0; i < workers.size(); i++ )
+            for ( size_t outIdx = 0; outIdx < nnOutputIndexes.size(); outIdx++ )
+                flushChunk(*workers.at(i), outIdx);
+    }
+    else
+    {
+        pwlInfoMerge(workers);
+        compactBoundProtData();
+
+        if ( checkpointing )
+            std::remove(checkpointFileName.c_str());
+
+        pwlTranslation = true;
+    }
 }
 
 pwl2limodsat::PiecewiseLinearFunctionData NeuralNetwork::getPwlData(unsigned nnOutputIdx)
@@ -592,7 +1094,10 @@ pwl2limodsat::PiecewiseLinearFunctionData NeuralNetwork::getPwlData(unsigned nnO
     if ( !pwlTranslation )
         net2pwl();
 
-    return pwlData.at(outIdx);
+    if ( pwlExpansion )
+        return expandedPwlData.at(outIdx);
+
+    return regionStore.getPwlData(outIdx);
 }
 
 pwl2limodsat::BoundaryPrototypeCollection NeuralNetwork::getBoundProtData()
@@ -609,6 +1114,367 @@ void NeuralNetwork::buildPwlData()
         net2pwl();
 }
 
+void NeuralNetwork::streamPwlFiles()
+{
+    pwlSinks.clear();
+    for ( size_t outIdx = 0; outIdx < nnOutputIndexes.size(); outIdx++ )
+        pwlSinks.push_back(std::unique_ptr<PwlStreamSink>(new PwlStreamSink(pwlFileName.at(outIdx))));
+
+    streaming = true;
+    net2pwl();
+    streaming = false;
+
+    pwlSinks.clear();
+}
+
+size_t NeuralNetwork::getPiecesNum(size_t outIdx)
+{
+    if ( pwlExpansion )
+        return expandedPwlData.at(outIdx).size();
+    else
+        return regionStore.getPiecesNum(outIdx);
+}
+
+void NeuralNetwork::expandPiece(size_t outIdx, size_t pieceIdx, pwl2limodsat::RegionalLinearPieceData& rlpData)
+{
+    if ( pwlExpansion )
+        rlpData = expandedPwlData.at(outIdx).at(pieceIdx);
+    else
+        regionStore.expandPiece(outIdx, pieceIdx, rlpData);
+}
+
+// Post-passes rewrite the regions one by one, so they are taken out of the
+// region store once
+void NeuralNetwork::expandPwlData()
+{
+    if ( pwlExpansion )
+        return;
+
+    for ( size_t outIdx = 0; outIdx < nnOutputIndexes.size(); outIdx++ )
+        expandedPwlData.push_back(regionStore.getPwlData(outIdx));
+
+    regionStore.clear();
+    pwlExpansion = true;
+}
+
+// Renumbers the prototypes still used by some region
+void NeuralNetwork::renumberBoundProtData()
+{
+    std::vector<pwl2limodsat::BoundProtIndex> newIdx(boundProtData.size(), NoRegionNode);
+    pwl2limodsat::BoundaryPrototypeCollection usedBoundProtData;
+
+    for ( pwl2limodsat::PiecewiseLinearFunctionData& pwlData : expandedPwlData )
+        for ( pwl2limodsat::RegionalLinearPieceData& rlpData : pwlData )
+            for ( pwl2limodsat::Boundary& bound : rlpData.bound )
+            {
+                if ( newIdx.at(bound.first) == NoRegionNode )
+                {
+                    newIdx.at(bound.first) = usedBoundProtData.size();
+                    usedBoundProtData.push_back(boundProtData.at(bound.first));
+                }
+
+                bound.first = newIdx.at(bound.first);
+            }
+
+    boundProtData.swap(usedBoundProtData);
+}
+
+// Columns are the inputs within the domain box and the first rows are the
+// constraints of the domain, followed by one row per boundary
+void NeuralNetwork::regionLp(soplex::SoPlex& sop, const pwl2limodsat::BoundaryCollection& boundData)
+{
+    size_t inputDim = getInputDimension();
+
+    soplex::DSVector dummycol(0);
+    for ( size_t j = 0; j < inputDim; j++ )
+        sop.addColReal(soplex::LPCol(0, dummycol, inputDomain.getUpper(j), inputDomain.getLower(j)));
+
+    size_t domainRowsNum = inputDomain.getConstraints().size();
+
+    for ( size_t i = 0; i < domainRowsNum + boundData.size(); i++ )
+    {
+        const pwl2limodsat::Boundary& bound = ( i < domainRowsNum ? inputDomain.getConstraints().at(i)
+                                                                  : boundData.at(i - domainRowsNum) );
+        const pwl2limodsat::BoundaryPrototype& boundProt = ( i < domainRowsNum ? inputDomain.getConstraintProts().at(bound.first)
+                                                                               : boundProtData.at(bound.first) );
+
+        soplex::DSVector row(inputDim);
+        for ( size_t j = 1; j <= inputDim; j++ )
+            row.add(j-1, boundProt.at(j));
+
+        if ( bound.second == pwl2limodsat::GeqZero )
+            sop.addRowReal(soplex::LPRow(-boundProt.at(0), row, soplex::infinity));
+        else
+            sop.addRowReal(soplex::LPRow(-soplex::infinity, row, -boundProt.at(0)));
+    }
+
+    sop.setIntParam(soplex::SoPlex::VERBOSITY, soplex::SoPlex::VERBOSITY_ERROR);
+}
+
+// Whether the affine value of a boundary stays on its side over an LP
+// region, where the boundary's own row, if any, has been relaxed
+bool NeuralNetwork::boundHolds(soplex::SoPlex& sop, const pwl2limodsat::Boundary& bound)
+{
+    const pwl2limodsat::BoundaryPrototype& boundProt = boundProtData.at(bound.first);
+    pwl2limodsat::BoundaryCoefficient K = -boundProt.at(0);
+    pwl2limodsat::BoundaryCoefficient tolerance = REDUNDANCY_TOLERANCE * std::max(1.0, std::abs(K));
+    bool geqZero = ( bound.second == pwl2limodsat::GeqZero );
+
+    for ( size_t j = 0; j < getInputDimension(); j++ )
+        sop.changeObjReal(j, boundProt.at(j+1));
+
+    sop.setIntParam(soplex::SoPlex::OBJSENSE, ( geqZero ? soplex::SoPlex::OBJSENSE_MINIMIZE : soplex::SoPlex::OBJSENSE_MAXIMIZE ));
+    sop.optimize();
+
+    if ( sop.status() != soplex::SPxSolver::OPTIMAL )
+        return false;
+
+    double value = sop.objValueReal();
+    return ( geqZero ? value >= K - tolerance : value <= K + tolerance );
+}
+
+// Drops every boundary implied by the others and the input domain: with its
+// own row relaxed, the boundary's affine value cannot cross zero
+void NeuralNetwork::reduceRegion(pwl2limodsat::RegionalLinearPieceData& rlpData)
+{
+    soplex::SoPlex sop;
+    regionLp(sop, rlpData.bound);
+
+    // Constraints of the input domain come first and are never relaxed
+    size_t domainRowsNum = inputDomain.getConstraints().size();
+
+    pwl2limodsat::BoundaryCollection reducedBound;
+
+    for ( size_t i = 0; i < rlpData.bound.size(); i++ )
+    {
+        sop.changeRangeReal(domainRowsNum + i, -soplex::infinity, soplex::infinity);
+
+        if ( !boundHolds(sop, rlpData.bound.at(i)) )
+        {
+            pwl2limodsat::BoundaryCoefficient K = -boundProtData.at(rlpData.bound.at(i).first).at(0);
+
+            if ( rlpData.bound.at(i).second == pwl2limodsat::GeqZero )
+                sop.changeRangeReal(domainRowsNum + i, K, soplex::infinity);
+            else
+                sop.changeRangeReal(domainRowsNum + i, -soplex::infinity, K);
+
+            reducedBound.push_back(rlpData.bound.at(i));
+        }
+    }
+
+    rlpData.bound.swap(reducedBound);
+}
+
+void NeuralNetwork::partialReduce(pwl2limodsat::PiecewiseLinearFunctionData& pwlData, size_t beginIdx, size_t endIdx)
+{
+    for ( size_t i = beginIdx; i < endIdx; i++ )
+        reduceRegion(pwlData.at(i));
+}
+
+void NeuralNetwork::reducePwlData()
+{
+    if ( !pwlTranslation )
+        net2pwl();
+
+    if ( pwlReduction )
+        return;
+
+    expandPwlData();
+
+    unsigned threadsNum = 1;
+    if ( processingMode == Multi )
+        threadsNum = std::max(1u, std::thread::hardware_concurrency());
+
+    for ( pwl2limodsat::PiecewiseLinearFunctionData& pwlData : expandedPwlData )
+    {
+        std::vector<std::future<void>> reduceFut;
+        for ( unsigned i = 0; i < threadsNum; i++ )
+            reduceFut.push_back( async(std::launch::async,
+                                       &NeuralNetwork::partialReduce,
+                                       this,
+                                       std::ref(pwlData),
+                                       i * pwlData.size() / threadsNum,
+                                       ( i + 1 ) * pwlData.size() / threadsNum) );
+
+        for ( size_t i = 0; i < reduceFut.size(); i++ )
+            reduceFut.at(i).get();
+    }
+
+    renumberBoundProtData();
+
+    pwlReduction = true;
+}
+
+// Two regions of the same linear piece whose boundaries only differ in the
+// sign of one of them, apart from boundaries each one satisfies anyway,
+// cover together the region bounded by all the others, which replaces the
+// first one
+bool NeuralNetwork::coalesceRegions(pwl2limodsat::RegionalLinearPieceData& first,
+                                    const pwl2limodsat::RegionalLinearPieceData& second)
+{
+    pwl2limodsat::BoundaryCollection firstBound = first.bound;
+    pwl2limodsat::BoundaryCollection secondBound = second.bound;
+    std::sort(firstBound.begin(), firstBound.end());
+    std::sort(secondBound.begin(), secondBound.end());
+
+    pwl2limodsat::BoundaryCollection firstOnly, secondOnly;
+    pwl2limodsat::BoundProtIndex splitIdx = 0;
+    size_t splitsNum = 0;
+
+    size_t i = 0, j = 0;
+    while ( ( i < firstBound.size() ) || ( j < secondBound.size() ) )
+    {
+        if ( ( j == secondBound.size() ) ||
+             ( ( i < firstBound.size() ) && ( firstBound.at(i).first < secondBound.at(j).first ) ) )
+            firstOnly.push_back(firstBound.at(i++));
+        else if ( ( i == firstBound.size() ) || ( secondBound.at(j).first < firstBound.at(i).first ) )
+            secondOnly.push_back(secondBound.at(j++));
+        else if ( firstBound.at(i).second == secondBound.at(j).second )
+        {
+            i++;
+            j++;
+        }
+        else
+        {
+            splitIdx = firstBound.at(i).first;
+            splitsNum++;
+            i++;
+            j++;
+        }
+
+        if ( splitsNum > 1 )
+            return false;
+    }
+
+    if ( splitsNum != 1 )
+        return false;
+
+    if ( !secondOnly.empty() )
+    {
+        soplex::SoPlex sop;
+        regionLp(sop, first.bound);
+
+        for ( const pwl2limodsat::Boundary& bound : secondOnly )
+            if ( !boundHolds(sop, bound) )
+                return false;
+    }
+
+    if ( !firstOnly.empty() )
+    {
+        soplex::SoPlex sop;
+        regionLp(sop, second.bound);
+
+        for ( const pwl2limodsat::Boundary& bound : firstOnly )
+            if ( !boundHolds(sop, bound) )
+                return false;
+    }
+
+    pwl2limodsat::BoundaryCollection coalescedBound;
+    for ( const pwl2limodsat::Boundary& bound : first.bound )
+        if ( bound.first != splitIdx )
+            coalescedBound.push_back(bound);
+    coalescedBound.insert(coalescedBound.end(), secondOnly.begin(), secondOnly.end());
+
+    first.bound.swap(coalescedBound);
+    return true;
+}
+
+// Merges regions of each group, sharing one linear piece, until no pair of
+// them can be merged; merged regions are marked as removed
+void NeuralNetwork::partialCoalesce(pwl2limodsat::PiecewiseLinearFunctionData& pwlData,
+                                    std::vector<std::vector<size_t>>& groups,
+                                    std::vector<char>& removed,
+                                    size_t beginIdx,
+                                    size_t endIdx)
+{
+    for ( size_t g = beginIdx; g < endIdx; g++ )
+    {
+        std::vector<size_t>& group = groups.at(g);
+        bool coalesced = true;
+
+        while ( coalesced )
+        {
+            coalesced = false;
+
+            for ( size_t i = 0; i < group.size(); i++ )
+                for ( size_t j = i+1; j < group.size(); j++ )
+                    if ( !removed.at(group.at(i)) && !removed.at(group.at(j)) &&
+                         coalesceRegions(pwlData.at(group.at(i)), pwlData.at(group.at(j))) )
+                    {
+                        removed.at(group.at(j)) = 1;
+                        coalesced = true;
+                    }
+
+            group.erase(std::remove_if(group.begin(), group.end(), [&removed](size_t idx) { return removed.at(idx); }), group.end());
+        }
+    }
+}
+
+void NeuralNetwork::coalescePwlData()
+{
+    if ( !pwlTranslation )
+        net2pwl();
+
+    if ( pwlCoalescence )
+        return;
+
+    expandPwlData();
+
+    unsigned threadsNum = 1;
+    if ( processingMode == Multi )
+        threadsNum = std::max(1u, std::thread::hardware_concurrency());
+
+    for ( pwl2limodsat::PiecewiseLinearFunctionData& pwlData : expandedPwlData )
+    {
+        // Regions are grouped by linear piece, in order of first appearance
+        std::map<pwl2limodsat::LinearPieceData, size_t> groupIdx;
+        std::vector<std::vector<size_t>> groups;
+
+        for ( size_t i = 0; i < pwlData.size(); i++ )
+        {
+            std::map<pwl2limodsat::LinearPieceData, size_t>::iterator it = groupIdx.find(pwlData.at(i).lpData);
+
+            if ( it == groupIdx.end() )
+            {
+                it = groupIdx.insert(std::make_pair(pwlData.at(i).lpData, groups.size())).first;
+                groups.push_back(std::vector<size_t>());
+            }
+
+            groups.at(it->second).push_back(i);
+        }
+
+        std::vector<char> removed(pwlData.size(), 0);
+
+        std::vector<std::future<void>> coalesceFut;
+        for ( unsigned i = 0; i < threadsNum; i++ )
+            coalesceFut.push_back( async(std::launch::async,
+                                         &NeuralNetwork::partialCoalesce,
+                                         this,
+                                         std::ref(pwlData),
+                                         std::ref(groups),
+                                         std::ref(removed),
+                                         i * groups.size() / threadsNum,
+                                         ( i + 1 ) * groups.size() / threadsNum) );
+
+        for ( size_t i = 0; i < coalesceFut.size(); i++ )
+            coalesceFut.at(i).get();
+
+        size_t coalescedSize = 0;
+        for ( size_t i = 0; i < pwlData.size(); i++ )
+            if ( !removed.at(i) )
+            {
+                if ( coalescedSize != i )
+                    pwlData.at(coalescedSize) = std::move(pwlData.at(i));
+                coalescedSize++;
+            }
+        pwlData.resize(coalescedSize);
+    }
+
+    renumberBoundProtData();
+
+    pwlCoalescence = true;
+}
+
 void NeuralNetwork::printPwlFile(unsigned nnOutputIdx)
 {
     size_t outIdx = getNnOutputIndexesIdx(nnOutputIdx);
@@ -635,34 +1501,38 @@ void NeuralNetwork::printPwlFile(unsigned nnOutputIdx)
         pwlFile << std::endl;
     }
 
-    for ( size_t i = 0; i < pwlData.at(outIdx).size(); i++ )
+    pwl2limodsat::RegionalLinearPieceData rlpData;
+
+    for ( size_t i = 0; i < getPiecesNum(outIdx); i++ )
     {
+        expandPiece(outIdx, i, rlpData);
+
         pwlFile << std::endl << "p ";
 
-        for ( size_t j = 0; j < pwlData.at(outIdx).at(i).lpData.size(); j++ )
+        for ( size_t j = 0; j < rlpData.lpData.size(); j++ )
         {
-            pwlFile << pwlData.at(outIdx).at(i).lpData.at(j).first << " " << pwlData.at(outIdx).at(i).lpData.at(j).second;
+            pwlFile << rlpData.lpData.at(j).first << " " << rlpData.lpData.at(j).second;
 
-            if ( j+1 != pwlData.at(outIdx).at(i).lpData.size() )
+            if ( j+1 != rlpData.lpData.size() )
                 pwlFile << " ";
             else
                 pwlFile << std::endl;
         }
 
-        for ( size_t j = 0; j < pwlData.at(outIdx).at(i).bound.size(); j++ )
+        for ( size_t j = 0; j < rlpData.bound.size(); j++ )
         {
-            if ( pwlData.at(outIdx).at(i).bound.at(j).second == pwl2limodsat::GeqZero )
+            if ( rlpData.bound.at(j).second == pwl2limodsat::GeqZero )
                 pwlFile << "g ";
             else
                 pwlFile << "l ";
 
-            pwlFile << pwlData.at(outIdx).at(i).bound.at(j).first + 1;
+            pwlFile << rlpData.bound.at(j).first + 1;
 
-            if ( j+1 != pwlData.at(outIdx).at(i).bound.size() )
+            if ( j+1 != rlpData.bound.size() )
                 pwlFile << std::endl;
         }
 
-        if ( i+1 != pwlData.at(outIdx).size() )
+        if ( i+1 != getPiecesNum(outIdx) )
             pwlFile << std::endl;
     }
 }
@@ -214,22 +214,57 @@ void NeuralNetworkModSat::printNNmodsatFile(unsigned nnOutputIdx)
     size_t outIdx = getNnOutputIndexesIdx(nnOutputIdx);
 
     std::ofstream liModSatFile(liModSatFileName.at(outIdx));
+    lukaFormula::FormulaWriter writer(&liModSatFile);
 
     if ( !NNmodsatRepresentation )
         net2limodsat();
 
-    liModSatFile << "-= Formula phi =-" << std::endl;
-    outputFormulaRep.at(outIdx).print(&liModSatFile);
+    writer.write("-= Formula phi =-\n");
+    writer.write(outputFormulaRep.at(outIdx));
 
-    liModSatFile << std::endl << "-= MODSAT Set Phi =-" << std::endl;
+    writer.write("\n-= MODSAT Set Phi =-\n");
 
-    for ( lukaFormula::Formula form : outputModsatRep )
+    for ( const lukaFormula::Formula& form : outputModsatRep )
     {
-        liModSatFile << "f:" << std::endl;
-        form.print(&liModSatFile);
+        writer.write("f:\n");
+        writer.write(form);
     }
 }
 
+void NeuralNetworkModSat::printNNmodsatBinaryFile(unsigned nnOutputIdx, bool compression)
+{
+    size_t outIdx = getNnOutputIndexesIdx(nnOutputIdx);
+
+    if ( !NNmodsatRepresentation )
+        net2limodsat();
+
+    lukaFormula::FormulaContainer container(lukaFormula::LimodsatContent, vm->currentVariable());
+
+    container.addSection(lukaFormula::PhiSection, outputFormulaRep.at(outIdx));
+    container.addSection(lukaFormula::PhiSetSection, outputModsatRep);
+
+    container.write(liModSatFileName.at(outIdx) + ".bin", compression);
+}
+
+void NeuralNetworkModSat::printNNsmtFile(unsigned nnOutputIdx)
+{
+    size_t outIdx = getNnOutputIndexesIdx(nnOutputIdx);
+
+    if ( !NNmodsatRepresentation )
+        net2limodsat();
+
+    std::ofstream smtFile(liModSatFileName.at(outIdx).substr(0, liModSatFileName.at(outIdx).size()-9) + ".smt2");
+    lukaFormula::SmtWriter writer(&smtFile);
+
+    writer.writeHeader(vm->currentVariable());
+    writer.definePhi(outputFormulaRep.at(outIdx));
+
+    for ( const lukaFormula::Formula& form : outputModsatRep )
+        writer.assertFormula(form);
+
+    writer.writeCheckSat(true);
+}
+
 std::map<unsigned,std::pair<double,double>> NeuralNetworkModSat::getOriginalOutputLim()
 {
     if ( !NNmodsatRepresentation )
@@ -238,19 +273,50 @@ std::map<unsigned,std::pair<double,double>> NeuralNetworkModSat::getOriginalOutp
     return originalOutputLim;
 }
 
-void NeuralNetworkModSat::printNNmodsat(std::ofstream *propertyFile, std::vector<pwl2limodsat::Variable> nnOutputVariables)
+void NeuralNetworkModSat::printNNmodsat(lukaFormula::FormulaWriter& writer, std::vector<pwl2limodsat::Variable> nnOutputVariables)
+{
+    for ( const lukaFormula::Formula& form : outputModsatRep )
+    {
+        writer.write("f:\n");
+        writer.write(form);
+    }
+
+    // The output formulas are left untouched, so that the property may also
+    // be written in the other formats
+    for ( size_t i = 0; i < outputFormulaRep.size(); i++ )
+    {
+        lukaFormula::Formula outputForm(outputFormulaRep.at(i));
+        outputForm.addEquivalence(lukaFormula::Formula(nnOutputVariables.at(i)));
+
+        writer.write("f:\n");
+        writer.write(outputForm);
+    }
+}
+
+// Same formulas as printNNmodsat, as a section of the container
+void NeuralNetworkModSat::addNNmodsat(lukaFormula::FormulaContainer& container, const std::vector<pwl2limodsat::Variable>& nnOutputVariables)
 {
-    for ( lukaFormula::Formula form : outputModsatRep )
+    lukaFormula::ModsatSet nnModsatSet(outputModsatRep);
+
+    for ( size_t i = 0; i < outputFormulaRep.size(); i++ )
     {
-        *propertyFile << "f:" << std::endl;
-        form.print(propertyFile);
+        nnModsatSet.push_back(outputFormulaRep.at(i));
+        nnModsatSet.back().addEquivalence(lukaFormula::Formula(nnOutputVariables.at(i)));
     }
 
+    container.addSection(lukaFormula::PhiSetSection, nnModsatSet);
+}
+
+void NeuralNetworkModSat::addNNsmt(lukaFormula::SmtWriter& writer, const std::vector<pwl2limodsat::Variable>& nnOutputVariables)
+{
+    for ( const lukaFormula::Formula& form : outputModsatRep )
+        writer.assertFormula(form);
+
     for ( size_t i = 0; i < outputFormulaRep.size(); i++ )
     {
-        *propertyFile << "f:" << std::endl;
-        outputFormulaRep.at(i).addEquivalence(lukaFormula::Formula(nnOutputVariables.at(i)));
-        outputFormulaRep.at(i).print(propertyFile);
+        lukaFormula::Formula outputForm(outputFormulaRep.at(i));
+        outputForm.addEquivalence(lukaFormula::Formula(nnOutputVariables.at(i)));
+        writer.assertFormula(outputForm);
     }
 }
 }
@@ -0,0 +1,96 @@
+#include <stdexcept>
+#include "PwlStreamSink.h"
+
+namespace reluka
+{
+PwlStreamSink::PwlStreamSink(std::string fileName) :
+    pwlFile(fileName)
+{
+    if ( !pwlFile.is_open() )
+        throw std::invalid_argument("Unable to open pwl file.");
+
+    pwlFile << "pwl" << std::endl << std::endl;
+}
+
+size_t PwlStreamChunk::addBoundProt(const pwl2limodsat::BoundaryPrototype& boundProt, pwl2limodsat::BoundProtIndex owner)
+{
+    if ( boundProtNum == boundProtData.size() )
+        boundProtData.push_back(boundProt);
+    else
+        boundProtData.at(boundProtNum).assign(boundProt.begin(), boundProt.end());
+
+    owners.push_back(owner);
+
+    return boundProtNum++;
+}
+
+PendingRegion& PwlStreamChunk::addRegion()
+{
+    if ( regionsNum == regions.size() )
+        regions.push_back(PendingRegion());
+
+    PendingRegion& region = regions.at(regionsNum++);
+    region.lpData.clear();
+    region.bound.clear();
+    region.pooled.clear();
+
+    return region;
+}
+
+void PwlStreamSink::write(const PwlStreamChunk& chunk, std::vector<pwl2limodsat::BoundProtIndex>& fileIdx)
+{
+    std::lock_guard<std::mutex> lock(sinkMutex);
+
+    fileIdx.clear();
+
+    for ( size_t i = 0; i < chunk.boundProtNum; i++ )
+    {
+        pwlFile << "b ";
+
+        for ( size_t j = 0; j < chunk.boundProtData.at(i).size(); j++ )
+        {
+            pwlFile << chunk.boundProtData.at(i).at(j);
+
+            if ( j + 1 != chunk.boundProtData.at(i).size() )
+                pwlFile << " ";
+        }
+
+        pwlFile << "\n";
+        fileIdx.push_back(boundProtCounter++);
+    }
+
+    for ( size_t i = 0; i < chunk.regionsNum; i++ )
+    {
+        const PendingRegion& region = chunk.regions.at(i);
+
+        pwlFile << "\np ";
+
+        for ( size_t j = 0; j < region.lpData.size(); j++ )
+        {
+            pwlFile << region.lpData.at(j).first << " " << region.lpData.at(j).second;
+
+            if ( j+1 != region.lpData.size() )
+                pwlFile << " ";
+        }
+
+        pwlFile << "\n";
+
+        for ( size_t j = 0; j < region.bound.size(); j++ )
+        {
+            if ( region.bound.at(j).second == pwl2limodsat::GeqZero )
+                pwlFile << "g ";
+            else
+                pwlFile << "l ";
+
+            if ( region.pooled.at(j) )
+                pwlFile << fileIdx.at(region.bound.at(j).first) + 1;
+            else
+                pwlFile << region.bound.at(j).first + 1;
+
+            pwlFile << "\n";
+        }
+    }
+
+    pwlFile.flush();
+}
+}
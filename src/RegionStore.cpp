@@ -0,0 +1,199 @@
+#include <stdexcept>
+#include <algorithm>
+#include <set>
+#include "RegionStore.h"
+
+namespace reluka
+{
+size_t RegionStore::addNode(size_t parent,
+                            pwl2limodsat::BoundProtIndex firstIdx,
+                            const std::vector<char>& cutting,
+                            const std::vector<pwl2limodsat::BoundarySymbol>& symbols)
+{
+    Node node;
+    node.parent = parent;
+    node.firstIdx = firstIdx;
+    node.bitOffset = 64 * bits.size();
+    node.width = cutting.size();
+    node.listed = false;
+
+    bits.resize(bits.size() + ( 2 * cutting.size() + 63 ) / 64, 0);
+
+    for ( size_t i = 0; i < cutting.size(); i++ )
+        if ( cutting.at(i) )
+        {
+            setBit(node.bitOffset + 2 * i);
+            if ( symbols.at(i) == pwl2limodsat::LeqZero )
+                setBit(node.bitOffset + 2 * i + 1);
+        }
+
+    nodes.push_back(node);
+
+    return nodes.size() - 1;
+}
+
+size_t RegionStore::addNode(size_t parent, const pwl2limodsat::BoundaryCollection& bound)
+{
+    Node node;
+    node.parent = parent;
+    node.firstIdx = listedIdx.size();
+    node.bitOffset = 64 * bits.size();
+    node.width = bound.size();
+    node.listed = true;
+
+    bits.resize(bits.size() + ( 2 * bound.size() + 63 ) / 64, 0);
+
+    for ( size_t i = 0; i < bound.size(); i++ )
+    {
+        listedIdx.push_back(bound.at(i).first);
+        setBit(node.bitOffset + 2 * i);
+        if ( bound.at(i).second == pwl2limodsat::LeqZero )
+            setBit(node.bitOffset + 2 * i + 1);
+    }
+
+    nodes.push_back(node);
+
+    return nodes.size() - 1;
+}
+
+void RegionStore::addPiece(size_t outIdx,
+                           size_t node,
+                           const pwl2limodsat::LinearPieceData& lpData,
+                           const pwl2limodsat::BoundaryCollection& tail)
+{
+    if ( tail.size() > 2 )
+        throw std::invalid_argument("A piece is closed by at most two output boundaries.");
+
+    Piece piece;
+    piece.lpData = lpData;
+    piece.node = node;
+    piece.tailNum = tail.size();
+
+    for ( size_t i = 0; i < tail.size(); i++ )
+        piece.tail[i] = tail.at(i);
+
+    pieces.at(outIdx).push_back(std::move(piece));
+}
+
+void RegionStore::expandPiece(size_t outIdx, size_t pieceIdx, pwl2limodsat::RegionalLinearPieceData& rlpData) const
+{
+    const Piece& piece = pieces.at(outIdx).at(pieceIdx);
+    std::vector<size_t> path;
+
+    for ( size_t node = piece.node; node != NoRegionNode; node = nodes.at(node).parent )
+        path.push_back(node);
+
+    rlpData.lpData = piece.lpData;
+    rlpData.bound.clear();
+
+    for ( size_t i = path.size(); i-- > 0; )
+    {
+        const Node& node = nodes.at(path.at(i));
+
+        for ( size_t j = 0; j < node.width; j++ )
+            if ( getBit(node.bitOffset + 2 * j) )
+                rlpData.bound.push_back(pwl2limodsat::Boundary(nodeIdx(node, j),
+                                                               getBit(node.bitOffset + 2 * j + 1) ? pwl2limodsat::LeqZero
+                                                                                                  : pwl2limodsat::GeqZero));
+    }
+
+    for ( size_t i = 0; i < piece.tailNum; i++ )
+        rlpData.bound.push_back(piece.tail[i]);
+
+    if ( !boundaryRemap.empty() )
+        remapBoundaries(rlpData.bound);
+}
+
+void RegionStore::remapBoundaries(pwl2limodsat::BoundaryCollection& bound) const
+{
+    for ( pwl2limodsat::Boundary& boundary : bound )
+    {
+        const pwl2limodsat::Boundary& target = boundaryRemap.at(boundary.first);
+
+        boundary.first = target.first;
+        if ( target.second == pwl2limodsat::LeqZero )
+            boundary.second = ( boundary.second == pwl2limodsat::GeqZero ? pwl2limodsat::LeqZero : pwl2limodsat::GeqZero );
+    }
+
+    // Hyperplanes merged by the remap may now repeat within a region
+    pwl2limodsat::BoundaryCollection sortedBound = bound;
+    std::sort(sortedBound.begin(), sortedBound.end());
+
+    if ( std::adjacent_find(sortedBound.begin(), sortedBound.end()) != sortedBound.end() )
+    {
+        std::set<pwl2limodsat::Boundary> seen;
+        pwl2limodsat::BoundaryCollection uniqueBound;
+
+        for ( const pwl2limodsat::Boundary& boundary : bound )
+            if ( seen.insert(boundary).second )
+                uniqueBound.push_back(boundary);
+
+        bound.swap(uniqueBound);
+    }
+}
+
+pwl2limodsat::PiecewiseLinearFunctionData RegionStore::getPwlData(size_t outIdx) const
+{
+    pwl2limodsat::PiecewiseLinearFunctionData pwlData(pieces.at(outIdx).size());
+
+    for ( size_t i = 0; i < pieces.at(outIdx).size(); i++ )
+        expandPiece(outIdx, i, pwlData.at(i));
+
+    return pwlData;
+}
+
+void RegionStore::append(RegionStore& other, pwl2limodsat::BoundProtIndex boundProtOffset)
+{
+    size_t nodeOffset = nodes.size();
+    size_t bitOffset = 64 * bits.size();
+    size_t listedOffset = listedIdx.size();
+
+    for ( Node node : other.nodes )
+    {
+        if ( node.parent != NoRegionNode )
+            node.parent += nodeOffset;
+        node.firstIdx += ( node.listed ? listedOffset : boundProtOffset );
+        node.bitOffset += bitOffset;
+        nodes.push_back(node);
+    }
+    bits.insert(bits.end(), other.bits.begin(), other.bits.end());
+
+    for ( pwl2limodsat::BoundProtIndex idx : other.listedIdx )
+        listedIdx.push_back(idx + boundProtOffset);
+
+    for ( size_t outIdx = 0; outIdx < other.pieces.size(); outIdx++ )
+        for ( Piece& piece : other.pieces.at(outIdx) )
+        {
+            if ( piece.node != NoRegionNode )
+                piece.node += nodeOffset;
+            for ( size_t i = 0; i < piece.tailNum; i++ )
+                piece.tail[i].first += boundProtOffset;
+            pieces.at(outIdx).push_back(std::move(piece));
+        }
+
+    other.clear();
+}
+
+void RegionStore::markReferenced(std::vector<char>& referenced) const
+{
+    for ( const Node& node : nodes )
+        for ( size_t j = 0; j < node.width; j++ )
+            if ( getBit(node.bitOffset + 2 * j) )
+                referenced.at(nodeIdx(node, j)) = 1;
+
+    for ( const std::vector<Piece>& outPieces : pieces )
+        for ( const Piece& piece : outPieces )
+            for ( size_t i = 0; i < piece.tailNum; i++ )
+                referenced.at(piece.tail[i].first) = 1;
+}
+
+void RegionStore::clear()
+{
+    nodes.clear();
+    bits.clear();
+    listedIdx.clear();
+    boundaryRemap.clear();
+    for ( std::vector<Piece>& outPieces : pieces )
+        outPieces.clear();
+}
+}
@@ -437,21 +437,50 @@ void VnnlibProperty::printLipropFile()
         throw std::invalid_argument("Pwl addresses are not coherent.");
 
     std::ofstream propertyFile(propertyFileName);
-    propertyFile << "Sat" << std::endl << std::endl;
+    lukaFormula::FormulaWriter writer(&propertyFile);
+    writer.write("Sat\n\n");
 
     for ( pwl2limodsat::PiecewiseLinearFunction pwl : *nnOutputAddresses )
     {
         for ( pwl2limodsat::RegionalLinearPiece rlp : pwl.getLinearPieceCollection() )
-            rlp.printModsatSetAs(&propertyFile, "f:");
+            rlp.printModsatSetAs(writer, "f:");
 
-        propertyFile << "f:" << std::endl;
-        pwl.getLatticeFormula().print(&propertyFile);
+        writer.write("f:\n");
+        writer.write(pwl.getLatticeFormula());
     }
 
-    for ( lukaFormula::Formula pForm : propertyFormulas )
+    for ( const lukaFormula::Formula& pForm : propertyFormulas )
     {
-        propertyFile << "f:" << std::endl;
-        pForm.print(&propertyFile);
+        writer.write("f:\n");
+        writer.write(pForm);
     }
 }
+
+void VnnlibProperty::printSmtFile()
+{
+    if ( !propertyBuilding )
+        buildVnnlibProperty();
+
+    if ( nnOutputDimension != nnOutputAddresses->size() )
+        throw std::invalid_argument("Pwl addresses are not coherent.");
+
+    std::ofstream smtFile(propertyFileName.substr(0, propertyFileName.size()-7) + ".smt2");
+    lukaFormula::SmtWriter writer(&smtFile);
+
+    writer.writeHeader(variableManager->currentVariable());
+
+    for ( pwl2limodsat::PiecewiseLinearFunction& pwl : *nnOutputAddresses )
+    {
+        for ( pwl2limodsat::RegionalLinearPiece& rlp : pwl.getLinearPieceCollection() )
+            for ( const lukaFormula::Formula& form : rlp.getRepresentationModsat().Phi )
+                writer.assertFormula(form);
+
+        writer.assertFormula(pwl.getLatticeFormula());
+    }
+
+    for ( const lukaFormula::Formula& pForm : propertyFormulas )
+        writer.assertFormula(pForm);
+
+    writer.writeCheckSat(false);
+}
 }
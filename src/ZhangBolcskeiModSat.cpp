@@ -187,19 +187,54 @@ void ZhangBolcskeiModSat::printZBmodsatFile(unsigned nnOutputIdx)
     size_t outIdx = getNnOutputIndexesIdx(nnOutputIdx);
 
     std::ofstream liModSatFile(liModSatFileName.at(outIdx));
+    lukaFormula::FormulaWriter writer(&liModSatFile);
 
     if ( !ZBmodsatRepresentation )
         net2limodsat();
 
-    liModSatFile << "-= Formula phi =-" << std::endl;
-    outputFormulaRep.at(outIdx).print(&liModSatFile);
+    writer.write("-= Formula phi =-\n");
+    writer.write(outputFormulaRep.at(outIdx));
 
-    liModSatFile << std::endl << "-= MODSAT Set Phi =-" << std::endl;
+    writer.write("\n-= MODSAT Set Phi =-\n");
 
-    for ( lukaFormula::Formula form : outputModsatRep )
+    for ( const lukaFormula::Formula& form : outputModsatRep )
     {
-        liModSatFile << "f:" << std::endl;
-        form.print(&liModSatFile);
+        writer.write("f:\n");
+        writer.write(form);
     }
 }
+
+void ZhangBolcskeiModSat::printZBmodsatBinaryFile(unsigned nnOutputIdx, bool compression)
+{
+    size_t outIdx = getNnOutputIndexesIdx(nnOutputIdx);
+
+    if ( !ZBmodsatRepresentation )
+        net2limodsat();
+
+    lukaFormula::FormulaContainer container(lukaFormula::LimodsatContent, vm->currentVariable());
+
+    container.addSection(lukaFormula::PhiSection, outputFormulaRep.at(outIdx));
+    container.addSection(lukaFormula::PhiSetSection, outputModsatRep);
+
+    container.write(liModSatFileName.at(outIdx) + ".bin", compression);
+}
+
+void ZhangBolcskeiModSat::printZBsmtFile(unsigned nnOutputIdx)
+{
+    size_t outIdx = getNnOutputIndexesIdx(nnOutputIdx);
+
+    if ( !ZBmodsatRepresentation )
+        net2limodsat();
+
+    std::ofstream smtFile(liModSatFileName.at(outIdx).substr(0, liModSatFileName.at(outIdx).size()-9) + ".smt2");
+    lukaFormula::SmtWriter writer(&smtFile);
+
+    writer.writeHeader(vm->currentVariable());
+    writer.definePhi(outputFormulaRep.at(outIdx));
+
+    for ( const lukaFormula::Formula& form : outputModsatRep )
+        writer.assertFormula(form);
+
+    writer.writeCheckSat(true);
+}
 }
@@ -27,8 +27,19 @@
 */
 
 #include <stdexcept>
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <limits>
+#include <zlib.h>
 #include "Formula.h"
 
+#define WRITE_BUFFER_SIZE (1 << 22)
+#define CONTAINER_MAGIC "LMSB"
+#define CONTAINER_VERSION 1
+#define COMPRESSED_SECTIONS 1
+#define ZLIB_MAX_RATIO 1032
+
 namespace lukaFormula
 {
 Formula::Formula()
@@ -85,14 +96,14 @@ Formula::Formula(std::vector<UnitClause> unitClausesInput,
                  std::vector<Implication> implicationsInput,
                  std::vector<Maximum> maximumsInput,
                  std::vector<Minimum> minimumsInput) :
-    unitClauses(unitClausesInput),
-    negations(negationsInput),
-    lDisjunctions(lDisjunctionsInput),
-    lConjunctions(lConjunctionsInput),
-    equivalences(equivalencesInput),
-    implications(implicationsInput),
-    maximums(maximumsInput),
-    minimums(minimumsInput)
+    unitClauses(std::move(unitClausesInput)),
+    negations(std::move(negationsInput)),
+    lDisjunctions(std::move(lDisjunctionsInput)),
+    lConjunctions(std::move(lConjunctionsInput)),
+    equivalences(std::move(equivalencesInput)),
+    implications(std::move(implicationsInput)),
+    maximums(std::move(maximumsInput)),
+    minimums(std::move(minimumsInput))
 {
     unitCounter = unitClauses.size()
                 + negations.size()
@@ -111,75 +122,111 @@ void Formula::negateFormula()
     unitCounter++;
 }
 
-void Formula::addUnits(const Formula& form)
+// Capacity grows geometrically, so that a formula built by repeated
+// additions copies each of its units a constant number of times on average
+template<class T> void Formula::reserveUnits(std::vector<T>& units, size_t addedUnitsNum)
 {
-    for ( size_t i = 0; i < form.getUnitClauses().size(); i++ )
-        unitClauses.push_back(UnitClause(form.getUnitClauses().at(i).first + unitCounter,
-                              form.getUnitClauses().at(i).second));
-
-    for ( size_t i = 0; i < form.getNegations().size(); i++ )
-        negations.push_back(Negation(form.getNegations().at(i).first + unitCounter,
-                            form.getNegations().at(i).second + unitCounter));
+    if ( units.size() + addedUnitsNum > units.capacity() )
+        units.reserve(std::max(units.size() + addedUnitsNum, 2 * units.capacity()));
+}
 
-    for ( size_t i = 0; i < form.getLDisjunctions().size(); i++ )
-        lDisjunctions.push_back( LDisjunction(std::get<0>(form.getLDisjunctions().at(i)) + unitCounter,
-                                              std::get<1>(form.getLDisjunctions().at(i)) + unitCounter,
-                                              std::get<2>(form.getLDisjunctions()[i]) + unitCounter) );
+void Formula::addShiftedOperations(std::vector<BinaryOperation>& binOps, const std::vector<BinaryOperation>& addedBinOps)
+{
+    reserveUnits(binOps, addedBinOps.size() + 1);
 
-    for ( size_t i = 0; i < form.getLConjunctions().size(); i++ )
-        lConjunctions.push_back( LConjunction(std::get<0>(form.getLConjunctions().at(i)) + unitCounter,
-                                              std::get<1>(form.getLConjunctions().at(i)) + unitCounter,
-                                              std::get<2>(form.getLConjunctions()[i]) + unitCounter) );
+    for ( const BinaryOperation& binOp : addedBinOps )
+        binOps.push_back( BinaryOperation(std::get<0>(binOp) + unitCounter,
+                                          std::get<1>(binOp) + unitCounter,
+                                          std::get<2>(binOp) + unitCounter) );
+}
 
-    for ( size_t i = 0; i < form.getEquivalences().size(); i++ )
-        equivalences.push_back( Equivalence(std::get<0>(form.getEquivalences().at(i)) + unitCounter,
-                                            std::get<1>(form.getEquivalences().at(i)) + unitCounter,
-                                            std::get<2>(form.getEquivalences()[i]) + unitCounter) );
+// The units of form are read in place; a formula added to itself is copied
+// first, since its vectors grow while being read
+void Formula::addUnits(const Formula& form)
+{
+    if ( &form == this )
+    {
+        Formula formCopy(form);
+        addUnits(formCopy);
+        return;
+    }
 
-    for ( size_t i = 0; i < form.getImplications().size(); i++ )
-        implications.push_back( Implication(std::get<0>(form.getImplications().at(i)) + unitCounter,
-                                            std::get<1>(form.getImplications().at(i)) + unitCounter,
-                                            std::get<2>(form.getImplications()[i]) + unitCounter) );
+    reserveUnits(unitClauses, form.unitClauses.size());
+    for ( const UnitClause& unitClause : form.unitClauses )
+        unitClauses.push_back(UnitClause(unitClause.first + unitCounter, unitClause.second));
 
-    for ( size_t i = 0; i < form.getMaximums().size(); i++ )
-        maximums.push_back( Maximum(std::get<0>(form.getMaximums().at(i)) + unitCounter,
-                                    std::get<1>(form.getMaximums().at(i)) + unitCounter,
-                                    std::get<2>(form.getMaximums()[i]) + unitCounter) );
+    reserveUnits(negations, form.negations.size());
+    for ( const Negation& negation : form.negations )
+        negations.push_back(Negation(negation.first + unitCounter, negation.second + unitCounter));
 
-    for ( size_t i = 0; i < form.getMinimums().size(); i++ )
-        minimums.push_back( Minimum(std::get<0>(form.getMinimums().at(i)) + unitCounter,
-                                    std::get<1>(form.getMinimums().at(i)) + unitCounter,
-                                    std::get<2>(form.getMinimums()[i]) + unitCounter) );
+    addShiftedOperations(lDisjunctions, form.lDisjunctions);
+    addShiftedOperations(lConjunctions, form.lConjunctions);
+    addShiftedOperations(equivalences, form.equivalences);
+    addShiftedOperations(implications, form.implications);
+    addShiftedOperations(maximums, form.maximums);
+    addShiftedOperations(minimums, form.minimums);
 }
 
-void Formula::addBinaryOperation(const Formula& form, LogicalSymbol binSym)
+std::vector<BinaryOperation>& Formula::binaryOperations(LogicalSymbol binSym)
 {
-    std::vector<BinaryOperation> *binOp;
-
     if ( binSym == Lor )
-        binOp = &lDisjunctions;
+        return lDisjunctions;
     else if ( binSym == Land )
-        binOp = &lConjunctions;
+        return lConjunctions;
     else if ( binSym == Equiv )
-        binOp = &equivalences;
+        return equivalences;
     else if ( binSym == Impl )
-        binOp = &implications;
+        return implications;
     else if ( binSym == Max )
-        binOp = &maximums;
+        return maximums;
     else if ( binSym == Min )
-        binOp = &minimums;
+        return minimums;
     else
         throw std::invalid_argument("Not a valid logic operation.");
+}
+
+void Formula::addBinaryOperation(const Formula& form, LogicalSymbol binSym)
+{
+    std::vector<BinaryOperation>& binOp = binaryOperations(binSym);
 
     addUnits(form);
 
-    binOp->push_back( BinaryOperation(unitCounter + form.getUnitCounter() + 1,
-                                      unitCounter,
-                                      unitCounter + form.getUnitCounter()) );
+    binOp.push_back( BinaryOperation(unitCounter + form.getUnitCounter() + 1,
+                                     unitCounter,
+                                     unitCounter + form.getUnitCounter()) );
 
     unitCounter += form.getUnitCounter() + 1;
 }
 
+UnitIndex Formula::addSharedFormula(const Formula& form)
+{
+    if ( form.isEmpty() )
+        throw std::invalid_argument("An empty formula cannot be shared.");
+
+    emptyFormula = false;
+
+    UnitIndex formUnitCounter = form.getUnitCounter();
+
+    addUnits(form);
+    unitCounter += formUnitCounter;
+
+    return unitCounter;
+}
+
+UnitIndex Formula::addOperation(UnitIndex unit1, UnitIndex unit2, LogicalSymbol binSym)
+{
+    if ( ( unit1 == 0 ) || ( unit1 > unitCounter ) || ( unit2 == 0 ) || ( unit2 > unitCounter ) )
+        throw std::invalid_argument("Not a unit of the formula.");
+
+    std::vector<BinaryOperation>& binOp = binaryOperations(binSym);
+    reserveUnits(binOp, 1);
+    binOp.push_back( BinaryOperation(unitCounter + 1, unit1, unit2) );
+
+    unitCounter++;
+
+    return unitCounter;
+}
+
 void Formula::addLukaDisjunction(const Formula& form)
 {
     if ( emptyFormula )
@@ -286,95 +333,634 @@ pwl2limodsat::Variable Formula::shiftVariables(std::vector<pwl2limodsat::Variabl
     return maximum;
 }
 
-void Formula::print(std::ofstream *output)
+void Formula::print(std::ofstream *output) const
+{
+    FormulaWriter writer(output);
+
+    writer.write(*this);
+}
+
+FormulaWriter::FormulaWriter(std::ostream *output) :
+    stream(output) {}
+
+FormulaWriter::~FormulaWriter()
+{
+    flush();
+}
+
+void FormulaWriter::flush()
+{
+    if ( stream && !buffer.empty() )
+    {
+        stream->write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+void FormulaWriter::writeFull()
+{
+    if ( buffer.size() >= WRITE_BUFFER_SIZE )
+        flush();
+}
+
+void FormulaWriter::write(const std::string& text)
+{
+    buffer += text;
+    writeFull();
+}
+
+void FormulaWriter::write(const char *text)
+{
+    buffer += text;
+    writeFull();
+}
+
+// A serialised buffer goes to the stream as it is, without being copied
+void FormulaWriter::write(const FormulaWriter& other)
+{
+    if ( stream )
+    {
+        flush();
+        stream->write(other.buffer.data(), other.buffer.size());
+    }
+    else
+        buffer += other.buffer;
+}
+
+void FormulaWriter::writeNumber(long long int value)
 {
-    unsigned unitClausesCounter = 0;
-    unsigned negationsCounter = 0;
-    unsigned disjunctionsCounter = 0;
-    unsigned conjunctionsCounter = 0;
-    unsigned equivalencesCounter = 0;
-    unsigned implicationsCounter = 0;
-    unsigned maximumsCounter = 0;
-    unsigned minimumsCounter = 0;
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
 
-    for ( unsigned i = 1; i <= unitCounter; i++ )
+    buffer.append(digits, result.ptr);
+}
+
+void FormulaWriter::writeOperation(UnitIndex unit, const char *name, const BinaryOperation& binOp)
+{
+    buffer += "Unit ";
+    writeNumber(unit);
+    buffer += name;
+    writeNumber(std::get<1>(binOp));
+    buffer += ' ';
+    writeNumber(std::get<2>(binOp));
+    buffer += '\n';
+}
+
+// Each typed array of units is sorted by unit index, so the arrays are
+// merged in a single pass with one cursor per array
+void FormulaWriter::write(const Formula& form)
+{
+    const std::vector<UnitClause>& unitClauses = form.getUnitClauses();
+    const std::vector<Negation>& negations = form.getNegations();
+    const std::vector<BinaryOperation> *binOps[] = { &form.getLDisjunctions(),
+                                                     &form.getLConjunctions(),
+                                                     &form.getEquivalences(),
+                                                     &form.getImplications(),
+                                                     &form.getMaximums(),
+                                                     &form.getMinimums() };
+    const char *binOpNames[] = { " :: Disjunction :: ",
+                                 " :: Conjunction :: ",
+                                 " :: Equivalence :: ",
+                                 " :: Implication :: ",
+                                 " :: Maximum     :: ",
+                                 " :: Minimum     :: " };
+    size_t unitClausesCursor = 0;
+    size_t negationsCursor = 0;
+    size_t binOpsCursors[] = { 0, 0, 0, 0, 0, 0 };
+
+    for ( UnitIndex i = 1; i <= form.getUnitCounter(); i++ )
     {
-        if ( (unitClausesCounter < unitClauses.size()) && (unitClauses.at(unitClausesCounter).first == i) )
+        if ( ( unitClausesCursor < unitClauses.size() ) && ( unitClauses[unitClausesCursor].first == i ) )
         {
-            *output << "Unit " << i << " :: Clause      :: ";
-            for ( size_t j = 0; j < unitClauses.at(unitClausesCounter).second.size(); j++ )
-                *output << unitClauses.at(unitClausesCounter).second.at(j) << " ";
-            *output << std::endl;
+            buffer += "Unit ";
+            writeNumber(i);
+            buffer += " :: Clause      :: ";
+            for ( Literal lit : unitClauses[unitClausesCursor].second )
+            {
+                writeNumber(lit);
+                buffer += ' ';
+            }
+            buffer += '\n';
 
-            unitClausesCounter++;
+            unitClausesCursor++;
         }
-        else if ( (negationsCounter < negations.size()) && (negations.at(negationsCounter).first == i) )
+        else if ( ( negationsCursor < negations.size() ) && ( negations[negationsCursor].first == i ) )
         {
-            *output << "Unit " << i << " :: Negation    :: ";
-            *output << negations.at(negationsCounter).second << std::endl;
+            buffer += "Unit ";
+            writeNumber(i);
+            buffer += " :: Negation    :: ";
+            writeNumber(negations[negationsCursor].second);
+            buffer += '\n';
 
-            negationsCounter++;
+            negationsCursor++;
         }
-        else if ( (disjunctionsCounter < lDisjunctions.size()) && (std::get<0>(lDisjunctions.at(disjunctionsCounter)) == i) )
+        else
         {
-            *output << "Unit " << i << " :: Disjunction :: ";
-            *output << std::get<1>(lDisjunctions.at(disjunctionsCounter))
-                    << " "
-                    << std::get<2>(lDisjunctions.at(disjunctionsCounter))
-                    << std::endl;
+            for ( size_t k = 0; k < 6; k++ )
+                if ( ( binOpsCursors[k] < binOps[k]->size() ) && ( std::get<0>((*binOps[k])[binOpsCursors[k]]) == i ) )
+                {
+                    writeOperation(i, binOpNames[k], (*binOps[k])[binOpsCursors[k]]);
+                    binOpsCursors[k]++;
+                    break;
+                }
+        }
+
+        writeFull();
+    }
+}
+
+SmtWriter::SmtWriter(std::ostream *output) :
+    writer(output) {}
 
-            disjunctionsCounter++;
+void SmtWriter::writeHeader(pwl2limodsat::Variable maxVar)
+{
+    writer.write("(set-logic QF_LRA)\n"
+                 "(define-fun min ((x Real) (y Real)) Real (ite (> x y) y x))\n"
+                 "(define-fun max ((x Real) (y Real)) Real (ite (> x y) x y))\n"
+                 "(define-fun neg ((x Real)) Real (- 1 x))\n"
+                 "(define-fun sdis ((x Real) (y Real)) Real (min 1 (+ x y)))\n"
+                 "(define-fun scon ((x Real) (y Real)) Real (max 0 (- (+ x y) 1)))\n"
+                 "(define-fun impl ((x Real) (y Real)) Real (min 1 (- (+ 1 y) x)))\n"
+                 "(define-fun equiv ((x Real) (y Real)) Real (- 1 (max (- x y) (- y x))))\n"
+                 "\n");
+
+    for ( pwl2limodsat::Variable var = 1; var <= maxVar; var++ )
+    {
+        writer.write("(declare-fun X");
+        writer.writeNumber(var);
+        writer.write(" () Real)\n(assert (<= 0 X");
+        writer.writeNumber(var);
+        writer.write(" 1))\n");
+    }
+
+    writer.write("\n");
+}
+
+// Units of different formulas are told apart by the number of the formula
+void SmtWriter::writeUnitName(UnitIndex unit)
+{
+    writer.write("u");
+    writer.writeNumber(formulasNum);
+    writer.write("_");
+    writer.writeNumber(unit);
+}
+
+void SmtWriter::writeLiteral(Literal lit)
+{
+    if ( lit > 0 )
+    {
+        writer.write(" X");
+        writer.writeNumber(lit);
+    }
+    else
+    {
+        writer.write(" (neg X");
+        writer.writeNumber(-(long long int) lit);
+        writer.write(")");
+    }
+}
+
+// A clause is the bounded sum of its literals; the other units apply the
+// function of their connective to the names of their operands
+void SmtWriter::defineUnits(const Formula& form)
+{
+    const std::vector<UnitClause>& unitClauses = form.getUnitClauses();
+    const std::vector<Negation>& negations = form.getNegations();
+    const std::vector<BinaryOperation> *binOps[] = { &form.getLDisjunctions(),
+                                                     &form.getLConjunctions(),
+                                                     &form.getEquivalences(),
+                                                     &form.getImplications(),
+                                                     &form.getMaximums(),
+                                                     &form.getMinimums() };
+    const char *binOpNames[] = { " (sdis ", " (scon ", " (equiv ", " (impl ", " (max ", " (min " };
+    size_t unitClausesCursor = 0;
+    size_t negationsCursor = 0;
+    size_t binOpsCursors[] = { 0, 0, 0, 0, 0, 0 };
+
+    formulasNum++;
+
+    for ( UnitIndex i = 1; i <= form.getUnitCounter(); i++ )
+    {
+        writer.write("(define-fun ");
+        writeUnitName(i);
+        writer.write(" () Real");
+
+        if ( ( unitClausesCursor < unitClauses.size() ) && ( unitClauses[unitClausesCursor].first == i ) )
+        {
+            const Clause& clause = unitClauses[unitClausesCursor].second;
+
+            if ( clause.size() == 1 )
+                writeLiteral(clause.front());
+            else
+            {
+                writer.write(" (min 1 (+");
+                for ( Literal lit : clause )
+                    writeLiteral(lit);
+                writer.write("))");
+            }
+
+            unitClausesCursor++;
         }
-        else if ( (conjunctionsCounter < lConjunctions.size()) && (std::get<0>(lConjunctions.at(conjunctionsCounter)) == i) )
+        else if ( ( negationsCursor < negations.size() ) && ( negations[negationsCursor].first == i ) )
         {
-            *output << "Unit " << i << " :: Conjunction :: ";
-            *output << std::get<1>(lConjunctions.at(conjunctionsCounter))
-                    << " "
-                    << std::get<2>(lConjunctions.at(conjunctionsCounter))
-                    << std::endl;
+            writer.write(" (neg ");
+            writeUnitName(negations[negationsCursor].second);
+            writer.write(")");
 
-            conjunctionsCounter++;
+            negationsCursor++;
         }
-        else if ( (equivalencesCounter < equivalences.size()) && (std::get<0>(equivalences.at(equivalencesCounter)) == i) )
+        else
         {
-            *output << "Unit " << i << " :: Equivalence :: ";
-            *output << std::get<1>(equivalences.at(equivalencesCounter))
-                    << " "
-                    << std::get<2>(equivalences.at(equivalencesCounter))
-                    << std::endl;
+            size_t k = 0;
+            while ( ( k < 6 ) && !( ( binOpsCursors[k] < binOps[k]->size() ) && ( std::get<0>((*binOps[k])[binOpsCursors[k]]) == i ) ) )
+                k++;
+
+            if ( k == 6 )
+                throw std::invalid_argument("Formula with missing units.");
 
-            equivalencesCounter++;
+            writer.write(binOpNames[k]);
+            writeUnitName(std::get<1>((*binOps[k])[binOpsCursors[k]]));
+            writer.write(" ");
+            writeUnitName(std::get<2>((*binOps[k])[binOpsCursors[k]]));
+            writer.write(")");
+
+            binOpsCursors[k]++;
         }
-        else if ( (implicationsCounter < implications.size()) && (std::get<0>(implications.at(implicationsCounter)) == i) )
+
+        writer.write(")\n");
+    }
+}
+
+void SmtWriter::definePhi(const Formula& form)
+{
+    if ( form.getUnitCounter() == 0 )
+        throw std::invalid_argument("Formula phi without units.");
+
+    defineUnits(form);
+
+    writer.write("(declare-fun phi () Real)\n(assert (= phi ");
+    writeUnitName(form.getUnitCounter());
+    writer.write("))\n\n");
+}
+
+void SmtWriter::assertFormula(const Formula& form)
+{
+    if ( form.getUnitCounter() == 0 )
+        return;
+
+    defineUnits(form);
+
+    writer.write("(assert (= ");
+    writeUnitName(form.getUnitCounter());
+    writer.write(" 1))\n\n");
+}
+
+// Asserts that the formula is not true, as for the conclusion of a consequence
+void SmtWriter::assertNotFormula(const Formula& form)
+{
+    if ( form.getUnitCounter() == 0 )
+        throw std::invalid_argument("Conclusion without units.");
+
+    defineUnits(form);
+
+    writer.write("(assert (< ");
+    writeUnitName(form.getUnitCounter());
+    writer.write(" 1))\n\n");
+}
+
+void SmtWriter::writeCheckSat(bool phiValue)
+{
+    writer.write("(check-sat)\n");
+
+    if ( phiValue )
+        writer.write("(get-value (phi))\n");
+}
+
+FormulaContainer::FormulaContainer(ContainerContent containerContent, pwl2limodsat::Variable maxVar) :
+    content(containerContent),
+    maxVariable(maxVar) {}
+
+void FormulaContainer::writeVarint(std::string& data, unsigned long long int value)
+{
+    while ( value >= 0x80 )
+    {
+        data += (char) ( ( value & 0x7f ) | 0x80 );
+        value >>= 7;
+    }
+
+    data += (char) value;
+}
+
+unsigned long long int FormulaContainer::readVarint(const std::string& data, size_t& pos)
+{
+    unsigned long long int value = 0;
+
+    for ( unsigned shift = 0; shift < 64; shift += 7 )
+    {
+        if ( pos >= data.size() )
+            throw std::invalid_argument("Not in binary formula container format.");
+
+        unsigned char byte = data[pos++];
+        value |= (unsigned long long int) ( byte & 0x7f ) << shift;
+
+        if ( !( byte & 0x80 ) )
+            return value;
+    }
+
+    throw std::invalid_argument("Not in binary formula container format.");
+}
+
+// A value read from a file is trusted only up to what the file can hold,
+// so that a corrupt length or index is reported instead of acted upon
+unsigned long long int FormulaContainer::readBounded(const std::string& data, size_t& pos, unsigned long long int maxValue)
+{
+    unsigned long long int value = readVarint(data, pos);
+
+    if ( value > maxValue )
+        throw std::invalid_argument("Not in binary formula container format.");
+
+    return value;
+}
+
+// Zigzag encoding, so that small negative values also take few bytes
+void FormulaContainer::writeSigned(std::string& data, long long int value)
+{
+    writeVarint(data, ( (unsigned long long int) value << 1 ) ^ (unsigned long long int) ( value >> 63 ));
+}
+
+long long int FormulaContainer::readSigned(const std::string& data, size_t& pos)
+{
+    unsigned long long int value = readVarint(data, pos);
+
+    return (long long int) ( value >> 1 ) ^ -(long long int) ( value & 1 );
+}
+
+// Operands are earlier units of the formula, stored as their distance
+UnitIndex FormulaContainer::readOperand(const std::string& data, size_t& pos, UnitIndex unit)
+{
+    long long int distance = readSigned(data, pos);
+
+    if ( ( distance < 1 ) || ( distance >= unit ) )
+        throw std::invalid_argument("Not in binary formula container format.");
+
+    return unit - distance;
+}
+
+// The unit counter followed by one record per unit in index order: a tag
+// telling the unit type, then the literals of a clause or the distances
+// from the unit to its operands
+void FormulaContainer::encode(std::string& data, const Formula& form)
+{
+    const std::vector<UnitClause>& unitClauses = form.getUnitClauses();
+    const std::vector<Negation>& negations = form.getNegations();
+    const std::vector<BinaryOperation> *binOps[] = { &form.getLDisjunctions(),
+                                                     &form.getLConjunctions(),
+                                                     &form.getEquivalences(),
+                                                     &form.getImplications(),
+                                                     &form.getMaximums(),
+                                                     &form.getMinimums() };
+    size_t unitClausesCursor = 0;
+    size_t negationsCursor = 0;
+    size_t binOpsCursors[] = { 0, 0, 0, 0, 0, 0 };
+
+    writeVarint(data, form.getUnitCounter());
+
+    for ( UnitIndex i = 1; i <= form.getUnitCounter(); i++ )
+    {
+        if ( ( unitClausesCursor < unitClauses.size() ) && ( unitClauses[unitClausesCursor].first == i ) )
         {
-            *output << "Unit " << i << " :: Implication :: ";
-            *output << std::get<1>(implications.at(implicationsCounter))
-                    << " "
-                    << std::get<2>(implications.at(implicationsCounter))
-                    << std::endl;
+            const Clause& clause = unitClauses[unitClausesCursor].second;
 
-            implicationsCounter++;
+            writeVarint(data, 0);
+            writeVarint(data, clause.size());
+            for ( Literal lit : clause )
+                writeSigned(data, lit);
+
+            unitClausesCursor++;
+            continue;
         }
-        else if ( (maximumsCounter < maximums.size()) && (std::get<0>(maximums.at(maximumsCounter)) == i) )
+        else if ( ( negationsCursor < negations.size() ) && ( negations[negationsCursor].first == i ) )
         {
-            *output << "Unit " << i << " :: Maximum     :: ";
-            *output << std::get<1>(maximums.at(maximumsCounter))
-                    << " "
-                    << std::get<2>(maximums.at(maximumsCounter))
-                    << std::endl;
+            writeVarint(data, 1);
+            writeSigned(data, (long long int) i - negations[negationsCursor].second);
 
-            maximumsCounter++;
+            negationsCursor++;
+            continue;
         }
-        else if ( (minimumsCounter < minimums.size()) && (std::get<0>(minimums.at(minimumsCounter)) == i) )
+
+        size_t k = 0;
+        while ( ( k < 6 ) && !( ( binOpsCursors[k] < binOps[k]->size() ) && ( std::get<0>((*binOps[k])[binOpsCursors[k]]) == i ) ) )
+            k++;
+
+        if ( k == 6 )
+            throw std::invalid_argument("Formula with missing units.");
+
+        const BinaryOperation& binOp = (*binOps[k])[binOpsCursors[k]];
+
+        writeVarint(data, k + 2);
+        writeSigned(data, (long long int) i - std::get<1>(binOp));
+        writeSigned(data, (long long int) i - std::get<2>(binOp));
+
+        binOpsCursors[k]++;
+    }
+}
+
+Formula FormulaContainer::decode(const std::string& data, size_t& pos)
+{
+    // Every unit takes at least two bytes
+    UnitIndex unitCounter = readBounded(data, pos, ( data.size() - pos ) / 2);
+
+    if ( unitCounter == 0 )
+        return Formula();
+
+    std::vector<UnitClause> unitClauses;
+    std::vector<Negation> negations;
+    std::vector<BinaryOperation> binOps[6];
+
+    for ( UnitIndex i = 1; i <= unitCounter; i++ )
+    {
+        unsigned long long int tag = readVarint(data, pos);
+
+        if ( tag == 0 )
         {
-            *output << "Unit " << i << " :: Minimum     :: ";
-            *output << std::get<1>(minimums.at(minimumsCounter))
-                    << " "
-                    << std::get<2>(minimums.at(minimumsCounter))
-                    << std::endl;
+            Clause clause(readBounded(data, pos, data.size() - pos));
+            for ( Literal& lit : clause )
+            {
+                long long int value = readSigned(data, pos);
+
+                if ( ( value == 0 ) || ( value > std::numeric_limits<Literal>::max() ) || ( value < -std::numeric_limits<Literal>::max() ) )
+                    throw std::invalid_argument("Not in binary formula container format.");
 
-            minimumsCounter++;
+                lit = (Literal) value;
+            }
+
+            unitClauses.push_back(UnitClause(i, std::move(clause)));
+        }
+        else if ( tag == 1 )
+            negations.push_back(Negation(i, readOperand(data, pos, i)));
+        else if ( tag < 8 )
+        {
+            UnitIndex unit1 = readOperand(data, pos, i);
+            UnitIndex unit2 = readOperand(data, pos, i);
+
+            binOps[tag-2].push_back(BinaryOperation(i, unit1, unit2));
+        }
+        else
+            throw std::invalid_argument("Not in binary formula container format.");
+    }
+
+    return Formula(std::move(unitClauses),
+                   std::move(negations),
+                   std::move(binOps[0]),
+                   std::move(binOps[1]),
+                   std::move(binOps[2]),
+                   std::move(binOps[3]),
+                   std::move(binOps[4]),
+                   std::move(binOps[5]));
+}
+
+void FormulaContainer::addSection(SectionKind kind, const Formula& form)
+{
+    addSection(kind, std::vector<Formula>(1, form));
+}
+
+void FormulaContainer::addSection(SectionKind kind, const std::vector<Formula>& forms)
+{
+    sections.push_back(Section{ kind, forms.size(), std::string() });
+
+    for ( const Formula& form : forms )
+        encode(sections.back().data, form);
+}
+
+std::vector<Formula> FormulaContainer::getFormulas(size_t i) const
+{
+    const Section& section = sections.at(i);
+    std::vector<Formula> forms;
+    size_t pos = 0;
+
+    forms.reserve(section.formulasNum);
+    for ( size_t j = 0; j < section.formulasNum; j++ )
+        forms.push_back(decode(section.data, pos));
+
+    if ( pos != section.data.size() )
+        throw std::invalid_argument("Not in binary formula container format.");
+
+    return forms;
+}
+
+// A header with the content, the largest variable and the section table,
+// in which each section gives its kind, its number of formulas and its
+// sizes before and after compression, followed by the sections themselves
+void FormulaContainer::write(std::string fileName, bool compression)
+{
+    std::ofstream containerFile(fileName, std::ios::binary);
+
+    if ( !containerFile.is_open() )
+        throw std::invalid_argument("Unable to open binary formula container file.");
+
+    std::vector<std::string> storedData(sections.size());
+
+    if ( compression )
+        for ( size_t i = 0; i < sections.size(); i++ )
+        {
+            uLongf storedSize = compressBound(sections.at(i).data.size());
+            storedData.at(i).resize(storedSize);
+
+            if ( compress2((Bytef*) &storedData.at(i)[0], &storedSize,
+                           (const Bytef*) sections.at(i).data.data(), sections.at(i).data.size(),
+                           Z_DEFAULT_COMPRESSION) != Z_OK )
+                throw std::runtime_error("Unable to compress binary formula container section.");
+
+            storedData.at(i).resize(storedSize);
         }
+
+    std::string header(CONTAINER_MAGIC);
+    header += (char) CONTAINER_VERSION;
+    header += (char) ( compression ? COMPRESSED_SECTIONS : 0 );
+    writeVarint(header, content);
+    writeVarint(header, maxVariable);
+    writeVarint(header, sections.size());
+
+    for ( size_t i = 0; i < sections.size(); i++ )
+    {
+        writeVarint(header, sections.at(i).kind);
+        writeVarint(header, sections.at(i).formulasNum);
+        writeVarint(header, sections.at(i).data.size());
+        writeVarint(header, ( compression ? storedData.at(i) : sections.at(i).data ).size());
+    }
+
+    containerFile.write(header.data(), header.size());
+
+    for ( size_t i = 0; i < sections.size(); i++ )
+    {
+        const std::string& data = ( compression ? storedData.at(i) : sections.at(i).data );
+        containerFile.write(data.data(), data.size());
     }
+
+    if ( !containerFile.good() )
+        throw std::runtime_error("Unable to write binary formula container file.");
+}
+
+void FormulaContainer::read(std::string fileName)
+{
+    std::ifstream containerFile(fileName, std::ios::binary);
+
+    if ( !containerFile.is_open() )
+        throw std::invalid_argument("Unable to open binary formula container file.");
+
+    std::string fileData((std::istreambuf_iterator<char>(containerFile)), std::istreambuf_iterator<char>());
+    std::string magic(CONTAINER_MAGIC);
+
+    if ( ( fileData.size() < magic.size() + 2 ) ||
+         ( fileData.compare(0, magic.size(), magic) != 0 ) ||
+         ( fileData[magic.size()] != CONTAINER_VERSION ) )
+        throw std::invalid_argument("Not in binary formula container format.");
+
+    bool compression = ( fileData[magic.size()+1] & COMPRESSED_SECTIONS );
+    size_t pos = magic.size() + 2;
+
+    content = (ContainerContent) readBounded(fileData, pos, SatContent);
+    maxVariable = readBounded(fileData, pos, std::numeric_limits<pwl2limodsat::Variable>::max());
+
+    // Every entry of the section table takes at least four bytes
+    sections.resize(readBounded(fileData, pos, ( fileData.size() - pos ) / 4));
+
+    std::vector<size_t> rawSizes(sections.size()), storedSizes(sections.size());
+    for ( size_t i = 0; i < sections.size(); i++ )
+    {
+        sections.at(i).kind = (SectionKind) readBounded(fileData, pos, ConclusionSection);
+        sections.at(i).formulasNum = readVarint(fileData, pos);
+        rawSizes.at(i) = readVarint(fileData, pos);
+        storedSizes.at(i) = readBounded(fileData, pos, fileData.size() - pos);
+    }
+
+    for ( size_t i = 0; i < sections.size(); i++ )
+    {
+        // A formula takes at least one byte, and zlib expands data at most
+        // ZLIB_MAX_RATIO times
+        if ( ( storedSizes.at(i) > fileData.size() - pos ) ||
+             ( sections.at(i).formulasNum > rawSizes.at(i) ) ||
+             ( compression ? ( rawSizes.at(i) > ZLIB_MAX_RATIO * storedSizes.at(i) )
+                           : ( rawSizes.at(i) != storedSizes.at(i) ) ) )
+            throw std::invalid_argument("Not in binary formula container format.");
+
+        if ( compression )
+        {
+            uLongf rawSize = rawSizes.at(i);
+            sections.at(i).data.resize(rawSize);
+
+            if ( ( uncompress((Bytef*) &sections.at(i).data[0], &rawSize,
+                              (const Bytef*) fileData.data() + pos, storedSizes.at(i)) != Z_OK ) ||
+                 ( rawSize != rawSizes.at(i) ) )
+                throw std::invalid_argument("Not in binary formula container format.");
+        }
+        else
+            sections.at(i).data.assign(fileData, pos, storedSizes.at(i));
+
+        pos += storedSizes.at(i);
+    }
+
+    if ( pos != fileData.size() )
+        throw std::invalid_argument("Not in binary formula container format.");
 }
 }
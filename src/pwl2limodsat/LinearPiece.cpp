@@ -323,7 +323,7 @@ void LinearPiece::representModsat()
     modsatTranslation = true;
 }
 
-Modsat LinearPiece::getRepresentationModsat()
+const Modsat& LinearPiece::getRepresentationModsat()
 {
     if ( !modsatTranslation )
         representModsat();
@@ -348,26 +348,43 @@ ModsatSet LinearPiece::getModsatSet()
 }
 
 void LinearPiece::printModsatSetAs(std::ofstream *output, std::string intro)
+{
+    FormulaWriter writer(output);
+
+    printModsatSetAs(writer, intro);
+}
+
+void LinearPiece::printModsatSetAs(FormulaWriter& writer, std::string intro)
 {
     if ( !modsatTranslation )
         representModsat();
 
     for ( size_t i = 0; i < representationModsat.Phi.size(); i++ )
     {
-        *output << intro << std::endl;
-        representationModsat.Phi.at(i).print(output);
+        writer.write(intro);
+        writer.write("\n");
+        writer.write(representationModsat.Phi.at(i));
     }
 }
 
 void LinearPiece::printModsatSet(std::ofstream *output)
+{
+    FormulaWriter writer(output);
+
+    printModsatSet(writer);
+}
+
+void LinearPiece::printModsatSet(FormulaWriter& writer)
 {
     if ( !modsatTranslation )
         representModsat();
 
     for ( size_t i = 0; i < representationModsat.Phi.size(); i++ )
     {
-        *output << "Formula " << i+1 << ":" << std::endl;
-        representationModsat.Phi.at(i).print(output);
+        writer.write("Formula ");
+        writer.writeNumber(i+1);
+        writer.write(":\n");
+        writer.write(representationModsat.Phi.at(i));
     }
 }
 
@@ -378,12 +395,16 @@ void LinearPiece::printLimodsatFile()
 
     std::ofstream outputFile(outputFileName);
 
-    outputFile << "-= Formula phi =-" << std::endl << std::endl;
-    representationModsat.phi.print(&outputFile);
+    {
+        FormulaWriter writer(&outputFile);
 
-    outputFile << std::endl << "-= MODSAT Set Phi =-" << std::endl << std::endl;
+        writer.write("-= Formula phi =-\n\n");
+        writer.write(representationModsat.phi);
 
-    printModsatSet(&outputFile);
+        writer.write("\n-= MODSAT Set Phi =-\n\n");
+
+        printModsatSet(writer);
+    }
 
     outputFile.close();
 }
@@ -28,8 +28,13 @@
 
 #include "PiecewiseLinearFunction.h"
 #include <iostream>
+#include <stdexcept>
 #include <future>
 #include <cmath>
+#include <algorithm>
+#include <mutex>
+
+#define PRINT_BATCH_PIECES 256
 
 namespace pwl2limodsat
 {
@@ -84,118 +89,240 @@ PiecewiseLinearFunction::~PiecewiseLinearFunction()
         delete var;
 }
 
-bool PiecewiseLinearFunction::hasLatticeProperty()
+// Threads take the rows still missing in turn. When checking the lattice
+// property, a finished row i is checked against every row finished before
+// it, in both orders, so each pair is checked once; the first pair without
+// the property stops every thread.
+void PiecewiseLinearFunction::comparedPositionsWorker(std::atomic<size_t>& nextRow,
+                                                      std::mutex& finishedMutex,
+                                                      std::vector<size_t>& finishedRows,
+                                                      std::atomic<bool>& violation,
+                                                      bool checkLatticeProperty)
 {
-    bool hasLatticeProperty = true;
+    std::vector<char> above, below;
+    std::vector<size_t> earlierRows;
 
-    for ( size_t i = 0; i < linearPieceCollection.size() && hasLatticeProperty; i++ )
-        for ( size_t j = 0; j < linearPieceCollection.size() && hasLatticeProperty; j++ )
-            if ( i != j )
-            {
-                bool found = false;
+    while ( !violation )
+    {
+        size_t i = nextRow++;
+
+        if ( i >= linearPieceCollection.size() )
+            break;
+        if ( rowComputed.at(i) )
+            continue;
+
+        linearPieceCollection.at(i).comparedPositions(linearPieceCollection, above, below);
 
-                for ( size_t k = 0; k < linearPieceCollection.size() && !found; k++ )
+        for ( size_t k = 0; k < linearPieceCollection.size(); k++ )
+        {
+            if ( above.at(k) )
+                comparedAbove.at(i * rowWords + k / 64) |= ( (uint64_t) 1 << ( k % 64 ) );
+            if ( below.at(k) )
+                comparedBelow.at(i * rowWords + k / 64) |= ( (uint64_t) 1 << ( k % 64 ) );
+        }
+
+        rowComputed.at(i) = 1;
+
+        {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            earlierRows = finishedRows;
+            finishedRows.push_back(i);
+        }
+
+        if ( checkLatticeProperty )
+            for ( size_t j : earlierRows )
+                if ( !latticePropertyHolds(i, j) || !latticePropertyHolds(j, i) )
                 {
-                    if ( linearPieceCollection.at(i).comparedIsBelow(linearPieceCollection.at(k)) )
-                        if ( linearPieceCollection.at(j).comparedIsAbove(linearPieceCollection.at(k)) )
-                            found = true;
+                    violation = true;
+                    break;
                 }
+    }
+}
 
-                if ( !found )
-                    hasLatticeProperty = false;
-            }
+// Every comparison is made once, one LP per region; each row fills whole
+// words of its own. Returns false when stopped at a pair without the
+// lattice property, leaving the rows computed so far for a later call.
+bool PiecewiseLinearFunction::computeComparedPositions(bool checkLatticeProperty)
+{
+    if ( comparedPositions )
+        return true;
 
-    return hasLatticeProperty;
+    size_t piecesNum = linearPieceCollection.size();
+
+    if ( rowComputed.empty() )
+    {
+        rowWords = ( piecesNum + 63 ) / 64;
+        comparedAbove.assign(piecesNum * rowWords, 0);
+        comparedBelow.assign(piecesNum * rowWords, 0);
+        rowComputed.assign(piecesNum, 0);
+    }
+
+    std::atomic<size_t> nextRow{0};
+    std::atomic<bool> violation{false};
+    std::mutex finishedMutex;
+    std::vector<size_t> finishedRows;
+
+    for ( size_t i = 0; i < piecesNum; i++ )
+        if ( rowComputed.at(i) )
+            finishedRows.push_back(i);
+
+    std::vector<std::future<void>> positionsFut;
+    for ( unsigned i = 0; i < workersNum(); i++ )
+        positionsFut.push_back( async(std::launch::async,
+                                      &PiecewiseLinearFunction::comparedPositionsWorker,
+                                      this,
+                                      std::ref(nextRow),
+                                      std::ref(finishedMutex),
+                                      std::ref(finishedRows),
+                                      std::ref(violation),
+                                      checkLatticeProperty) );
+
+    for ( size_t i = 0; i < positionsFut.size(); i++ )
+        positionsFut.at(i).get();
+
+    if ( violation )
+        return false;
+
+    comparedPositions = true;
+    return true;
 }
 
-unsigned long long int PiecewiseLinearFunction::latticePropertyCounter()
+// Whether some piece lies below piece i on its region and above piece j on
+// its region
+bool PiecewiseLinearFunction::latticePropertyHolds(size_t i, size_t j) const
 {
-    unsigned long long int counter = 0;
+    for ( size_t w = 0; w < rowWords; w++ )
+        if ( comparedBelow[i * rowWords + w] & comparedAbove[j * rowWords + w] )
+            return true;
+
+    return false;
+}
+
+void PiecewiseLinearFunction::violationsWorker(std::atomic<size_t>& nextRow,
+                                               std::atomic<unsigned long long int>& violationsNum,
+                                               bool stopAtViolation)
+{
+    while ( !( stopAtViolation && ( violationsNum > 0 ) ) )
+    {
+        size_t i = nextRow++;
+
+        if ( i >= linearPieceCollection.size() )
+            break;
 
-    for ( size_t i = 0; i < linearPieceCollection.size(); i++ )
         for ( size_t j = 0; j < linearPieceCollection.size(); j++ )
-            if ( i != j )
+            if ( ( i != j ) && !latticePropertyHolds(i, j) )
             {
-                bool found = false;
-
-                for ( size_t k = 0; k < linearPieceCollection.size() && !found; k++ )
-                {
-                    if ( linearPieceCollection.at(i).comparedIsBelow(linearPieceCollection.at(k)) )
-                        if ( linearPieceCollection.at(j).comparedIsAbove(linearPieceCollection.at(k)) )
-                            found = true;
-                }
+                violationsNum++;
 
-                if ( !found )
-                    counter++;
+                if ( stopAtViolation )
+                    break;
             }
+    }
+}
 
-    return counter;
+// Pairs without the lattice property, counted over the rows of the
+// computed comparisons
+unsigned long long int PiecewiseLinearFunction::countViolations(bool stopAtViolation)
+{
+    std::atomic<size_t> nextRow{0};
+    std::atomic<unsigned long long int> violationsNum{0};
+
+    std::vector<std::future<void>> violationsFut;
+    for ( unsigned i = 0; i < workersNum(); i++ )
+        violationsFut.push_back( async(std::launch::async,
+                                       &PiecewiseLinearFunction::violationsWorker,
+                                       this,
+                                       std::ref(nextRow),
+                                       std::ref(violationsNum),
+                                       stopAtViolation) );
+
+    for ( size_t i = 0; i < violationsFut.size(); i++ )
+        violationsFut.at(i).get();
+
+    return violationsNum;
 }
 
-void PiecewiseLinearFunction::representPiecesModSat()
+unsigned PiecewiseLinearFunction::workersNum()
 {
-    for ( size_t i = 0; i < linearPieceCollection.size(); i++ )
-        linearPieceCollection.at(i).representModsat();
+    if ( processingMode == Multi )
+        return std::max(1u, std::thread::hardware_concurrency());
+    else
+        return 1;
 }
 
-std::vector<Formula> PiecewiseLinearFunction::partialPhiOmega(unsigned thread, unsigned compByThread)
+void PiecewiseLinearFunction::setExact(bool exactComparisons)
 {
-    std::vector<Formula> partPhiOmega;
+    if ( comparedPositions || latticePropertyViolation )
+        throw std::logic_error("Exact comparisons set after the pieces were compared.");
 
-    for ( size_t i = thread * compByThread; i < (thread + 1) * compByThread; i++ )
-    {
-        partPhiOmega.push_back( linearPieceCollection.at(i).getRepresentationModsat().phi );
+    for ( RegionalLinearPiece& rlp : linearPieceCollection )
+        rlp.setExact(exactComparisons);
+}
 
-        for ( size_t k = 0; k < linearPieceCollection.size(); k++ )
-            if ( k != i )
-                if ( linearPieceCollection.at(i).comparedIsAbove(linearPieceCollection.at(k)) )
-                    partPhiOmega.back().addMinimum(linearPieceCollection.at(k).getRepresentationModsat().phi);
+bool PiecewiseLinearFunction::hasLatticeProperty()
+{
+    if ( latticePropertyViolation )
+        return false;
+
+    // Computing the comparisons also checks every pair
+    if ( !comparedPositions )
+    {
+        latticePropertyViolation = !computeComparedPositions(true);
+        return !latticePropertyViolation;
     }
 
-    return partPhiOmega;
+    latticePropertyViolation = ( countViolations(true) > 0 );
+    return !latticePropertyViolation;
+}
+
+unsigned long long int PiecewiseLinearFunction::latticePropertyCounter()
+{
+    computeComparedPositions(false);
+
+    return countViolations(false);
 }
 
-void PiecewiseLinearFunction::representLatticeFormula(unsigned maxThreadsNum)
+void PiecewiseLinearFunction::representPiecesModSat()
 {
-    unsigned compByThread = ceil( (float) linearPieceCollection.size() / (float) maxThreadsNum );
-    unsigned threadsNum = ceil( (float) linearPieceCollection.size() / (float) compByThread );
+    for ( size_t i = 0; i < linearPieceCollection.size(); i++ )
+        linearPieceCollection.at(i).representModsat();
+}
 
-    std::vector<std::future<std::vector<Formula>>> phiOmegaFut;
-    for ( unsigned thread = 0; thread < threadsNum - 1; thread++ )
-        phiOmegaFut.push_back( async(&PiecewiseLinearFunction::partialPhiOmega, this, thread, compByThread) );
+// Each formula phi of a piece is written once and referenced by index in the
+// minimums it takes part in, so the lattice formula grows with the number of
+// comparisons plus the size of the pieces' formulas, not with their product
+void PiecewiseLinearFunction::representLatticeFormula()
+{
+    computeComparedPositions(false);
 
-    std::vector<Formula> phiOmegaFirst;
-    for ( size_t i = (threadsNum - 1) * compByThread; i < linearPieceCollection.size(); i++ )
-    {
-        phiOmegaFirst.push_back( linearPieceCollection.at(i).getRepresentationModsat().phi );
+    latticeFormula = Formula();
 
-        for ( size_t k = 0; k < linearPieceCollection.size(); k++ )
-            if ( k != i )
-                if ( linearPieceCollection.at(i).comparedIsAbove(linearPieceCollection.at(k)) )
-                    phiOmegaFirst.back().addMinimum(linearPieceCollection.at(k).getRepresentationModsat().phi);
-    }
+    std::vector<lukaFormula::UnitIndex> phiUnits(linearPieceCollection.size());
+    for ( size_t i = 0; i < linearPieceCollection.size(); i++ )
+        phiUnits.at(i) = latticeFormula.addSharedFormula(linearPieceCollection.at(i).getRepresentationModsat().phi);
 
-    latticeFormula = phiOmegaFirst.at(0);
-    for ( size_t i = 1; i < phiOmegaFirst.size(); i++ )
-        latticeFormula.addMaximum(phiOmegaFirst.at(i));
+    lukaFormula::UnitIndex maximumUnit = 0;
 
-    for ( unsigned thread = 0; thread < threadsNum - 1; thread++ )
+    for ( size_t i = 0; i < linearPieceCollection.size(); i++ )
     {
-        std::vector<Formula> phiOmega = phiOmegaFut.at(thread).get();
+        lukaFormula::UnitIndex minimumUnit = phiUnits.at(i);
+
+        for ( size_t k = 0; k < linearPieceCollection.size(); k++ )
+            if ( k != i )
+                if ( isComparedAbove(i, k) )
+                    minimumUnit = latticeFormula.addOperation(minimumUnit, phiUnits.at(k), lukaFormula::Min);
 
-        for ( size_t i = 0; i < phiOmega.size(); i++ )
-            latticeFormula.addMaximum(phiOmega.at(i));
+        if ( i == 0 )
+            maximumUnit = minimumUnit;
+        else
+            maximumUnit = latticeFormula.addOperation(maximumUnit, minimumUnit, lukaFormula::Max);
     }
 }
 
 void PiecewiseLinearFunction::representModsat()
 {
     representPiecesModSat();
-
-    if ( processingMode == Multi )
-        representLatticeFormula(std::thread::hardware_concurrency());
-    else if ( processingMode == Single )
-        representLatticeFormula(1);
+    representLatticeFormula();
 
     modsatTranslation = true;
 }
@@ -224,23 +351,101 @@ Formula PiecewiseLinearFunction::getLatticeFormula()
     return latticeFormula;
 }
 
+void PiecewiseLinearFunction::printModsatSets(size_t begin, size_t end, lukaFormula::FormulaWriter *writer)
+{
+    for ( size_t i = begin; i < end; i++ )
+    {
+        writer->write("\n-= Linear Piece ");
+        writer->writeNumber(i+1);
+        writer->write(" =-\n");
+        linearPieceCollection.at(i).printModsatSet(*writer);
+    }
+}
+
+// The sets of the pieces are serialised by the workers into their own
+// buffers, a batch of consecutive pieces each, and written in piece order
 void PiecewiseLinearFunction::printLimodsatFile()
 {
     if ( !modsatTranslation )
         representModsat();
 
     std::ofstream outputFile(outputFileName);
+    lukaFormula::FormulaWriter writer(&outputFile);
 
-    //outputFile << "-= Formula phi =-" << std::endl << std::endl;
-    outputFile << "-= Formula phi =- MAXVAR " << var->currentVariable() << std::endl << std::endl;
-    latticeFormula.print(&outputFile);
+    writer.write("-= Formula phi =- MAXVAR ");
+    writer.writeNumber(var->currentVariable());
+    writer.write("\n\n");
+    writer.write(latticeFormula);
 
-    outputFile << std::endl << "-= MODSAT Set Phi =-" << std::endl;
+    writer.write("\n-= MODSAT Set Phi =-\n");
 
-    for ( size_t i = 0; i < linearPieceCollection.size(); i++ )
+    unsigned threadsNum = workersNum();
+    std::vector<lukaFormula::FormulaWriter> pieceWriters(threadsNum);
+
+    for ( size_t batchBegin = 0; batchBegin < linearPieceCollection.size(); batchBegin += threadsNum * PRINT_BATCH_PIECES )
     {
-        outputFile << std::endl << "-= Linear Piece " << i+1 << " =-" << std::endl;
-        linearPieceCollection.at(i).printModsatSet(&outputFile);
+        std::vector<std::future<void>> printFut;
+
+        for ( unsigned thread = 1; thread < threadsNum; thread++ )
+        {
+            size_t begin = std::min(linearPieceCollection.size(), batchBegin + thread * PRINT_BATCH_PIECES);
+            size_t end = std::min(linearPieceCollection.size(), begin + PRINT_BATCH_PIECES);
+
+            printFut.push_back( async(std::launch::async,
+                                      &PiecewiseLinearFunction::printModsatSets,
+                                      this,
+                                      begin,
+                                      end,
+                                      &pieceWriters.at(thread)) );
+        }
+
+        printModsatSets(batchBegin, std::min(linearPieceCollection.size(), batchBegin + PRINT_BATCH_PIECES), &pieceWriters.at(0));
+
+        for ( size_t i = 0; i < printFut.size(); i++ )
+            printFut.at(i).get();
+
+        for ( lukaFormula::FormulaWriter& pieceWriter : pieceWriters )
+        {
+            writer.write(pieceWriter);
+            pieceWriter.clear();
+        }
     }
 }
+
+// Same content as the .limodsat file, with the set of each piece in its own
+// section, written to <output file>.bin
+void PiecewiseLinearFunction::printLimodsatBinaryFile(bool compression)
+{
+    if ( !modsatTranslation )
+        representModsat();
+
+    lukaFormula::FormulaContainer container(lukaFormula::LimodsatContent, var->currentVariable());
+
+    container.addSection(lukaFormula::PhiSection, latticeFormula);
+
+    for ( RegionalLinearPiece& piece : linearPieceCollection )
+        container.addSection(lukaFormula::PhiSetSection, piece.getRepresentationModsat().Phi);
+
+    container.write(outputFileName + ".bin", compression);
+}
+
+// The lattice formula as phi and the sets of the pieces asserted true, in
+// SMT-LIB2 written to a .smt2 file named as the .limodsat file
+void PiecewiseLinearFunction::printSmtFile()
+{
+    if ( !modsatTranslation )
+        representModsat();
+
+    std::ofstream smtFile(outputFileName.substr(0, outputFileName.size()-9) + ".smt2");
+    lukaFormula::SmtWriter writer(&smtFile);
+
+    writer.writeHeader(var->currentVariable());
+    writer.definePhi(latticeFormula);
+
+    for ( RegionalLinearPiece& piece : linearPieceCollection )
+        for ( const Formula& form : piece.getRepresentationModsat().Phi )
+            writer.assertFormula(form);
+
+    writer.writeCheckSat(true);
+}
 }
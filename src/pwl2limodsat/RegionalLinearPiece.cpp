@@ -28,9 +28,15 @@
 
 #include "RegionalLinearPiece.h"
 
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
 #include "soplex.h"
 
 #define PREC 100000
+#define SAMPLES_NUM 8
+#define SAMPLE_MARGIN 1e-6
+#define EXACT_BAND 1e-3
 
 namespace pwl2limodsat
 {
@@ -41,30 +47,13 @@ RegionalLinearPiece::RegionalLinearPiece(const RegionalLinearPieceData& rlpData,
     boundaryData(rlpData.bound),
     boundaryPrototypeData(bpData) {}
 
-bool RegionalLinearPiece::position(Position pos, const RegionalLinearPiece& comparedRlp)
+// Columns are the inputs within the unit cube and rows the boundaries of
+// the region; objectives are set by each comparison
+void RegionalLinearPiece::regionLp(soplex::SoPlex& sop)
 {
-    std::vector<float> objFunc;
-
-    if ( pos == ComparedIsAbove )
-        for ( unsigned i = 0; i <= dim; i++ )
-            objFunc.push_back( ( (float) linearPieceData.at(i).first /
-                                 (float) linearPieceData.at(i).second ) -
-                               ( (float) comparedRlp.getLinearPieceData().at(i).first /
-                                 (float) comparedRlp.getLinearPieceData().at(i).second ) );
-    else if ( pos == ComparedIsBelow )
-        for ( unsigned i = 0; i <= dim; i++ )
-            objFunc.push_back( ( (float) comparedRlp.getLinearPieceData().at(i).first /
-                                 (float) comparedRlp.getLinearPieceData().at(i).second ) -
-                               ( (float) linearPieceData.at(i).first /
-                                 (float) linearPieceData.at(i).second ) );
-
-    float K = -objFunc.at(0);
-
-    soplex::SoPlex sop;
-
     soplex::DSVector dummycol(0);
     for ( unsigned i = 1; i <= dim; i++ )
-        sop.addColReal(soplex::LPCol(objFunc.at(i), dummycol, 1, 0));
+        sop.addColReal(soplex::LPCol(0, dummycol, 1, 0));
 
     soplex::DSVector row(dim);
     for ( size_t i = 0; i < boundaryData.size(); i++ )
@@ -82,8 +71,89 @@ bool RegionalLinearPiece::position(Position pos, const RegionalLinearPiece& comp
 
     sop.setIntParam(soplex::SoPlex::VERBOSITY, soplex::SoPlex::VERBOSITY_ERROR);
     sop.setIntParam(soplex::SoPlex::OBJSENSE, soplex::SoPlex::OBJSENSE_MAXIMIZE);
-    sop.optimize();
-    float Max = sop.objValueReal();
+}
+
+// Whether the objective exceeds K at some sample of the region by more
+// than the comparison tolerance, in which case the LP maximum does too
+bool RegionalLinearPiece::sampleExceeds(const std::vector<float>& objFunc, float K)
+{
+    double threshold = K + (float) 1/PREC + SAMPLE_MARGIN * std::max(1.0, (double) std::fabs(K));
+
+    if ( exact )
+        threshold = K + EXACT_BAND * std::max(1.0, (double) std::fabs(K));
+
+    for ( size_t s = 0; s < samplesNum; s++ )
+    {
+        const double *sample = samples.data() + s * dim;
+        double value = 0;
+
+        for ( unsigned i = 0; i < dim; i++ )
+            value += objFunc[i+1] * sample[i];
+
+        if ( value > threshold )
+            return true;
+    }
+
+    return false;
+}
+
+// Keeps the solution of an LP over the region as a sample, unless already kept
+void RegionalLinearPiece::addSample(soplex::SoPlex& sop)
+{
+    if ( ( samplesNum == SAMPLES_NUM ) || ( sop.status() != soplex::SPxSolver::OPTIMAL ) )
+        return;
+
+    soplex::DVector primal(dim);
+    sop.getPrimalReal(primal);
+
+    for ( size_t s = 0; s < samplesNum; s++ )
+    {
+        bool equal = true;
+        for ( unsigned i = 0; i < dim && equal; i++ )
+            equal = ( samples[s * dim + i] == primal[i] );
+
+        if ( equal )
+            return;
+    }
+
+    for ( unsigned i = 0; i < dim; i++ )
+        samples.push_back(primal[i]);
+    samplesNum++;
+}
+
+// The LP over the region is only built once some comparison is not
+// settled by the samples
+bool RegionalLinearPiece::position(std::unique_ptr<soplex::SoPlex>& sop, Position pos, const RegionalLinearPiece& comparedRlp)
+{
+    const LinearPieceData& upperData = ( pos == ComparedIsAbove ? linearPieceData : comparedRlp.linearPieceData );
+    const LinearPieceData& lowerData = ( pos == ComparedIsAbove ? comparedRlp.linearPieceData : linearPieceData );
+
+    objFunc.resize(dim+1);
+    for ( unsigned i = 0; i <= dim; i++ )
+        objFunc[i] = ( (float) upperData[i].first / (float) upperData[i].second ) -
+                     ( (float) lowerData[i].first / (float) lowerData[i].second );
+
+    float K = -objFunc.at(0);
+
+    if ( sampleExceeds(objFunc, K) )
+        return false;
+
+    if ( !sop )
+    {
+        sop.reset(new soplex::SoPlex);
+        regionLp(*sop);
+    }
+
+    for ( unsigned i = 1; i <= dim; i++ )
+        sop->changeObjReal(i-1, objFunc.at(i));
+
+    sop->optimize();
+    float Max = sop->objValueReal();
+
+    addSample(*sop);
+
+    if ( exact && ( std::fabs(K-Max) < EXACT_BAND * std::max(1.0f, std::fabs(K)) ) )
+        return exactPosition(pos, comparedRlp);
 
     if ( ( K > Max ) || ( abs(K-Max) < (float) 1/PREC ) )
         return true;
@@ -91,6 +161,83 @@ bool RegionalLinearPiece::position(Position pos, const RegionalLinearPiece& comp
         return false;
 }
 
+// Whether the difference of the pieces, taken exactly from their fractions,
+// is at most zero over the region, by a rational LP over the unit cube
+bool RegionalLinearPiece::exactPosition(Position pos, const RegionalLinearPiece& comparedRlp)
+{
+    const LinearPieceData& upperData = ( pos == ComparedIsAbove ? linearPieceData : comparedRlp.linearPieceData );
+    const LinearPieceData& lowerData = ( pos == ComparedIsAbove ? comparedRlp.linearPieceData : linearPieceData );
+    std::vector<soplex::Rational> objFunc;
+
+    for ( unsigned i = 0; i <= dim; i++ )
+        objFunc.push_back( soplex::Rational((double) upperData.at(i).first) / soplex::Rational((double) upperData.at(i).second) -
+                           soplex::Rational((double) lowerData.at(i).first) / soplex::Rational((double) lowerData.at(i).second) );
+
+    soplex::SoPlex sop;
+
+    sop.setIntParam(soplex::SoPlex::READMODE, soplex::SoPlex::READMODE_RATIONAL);
+    sop.setIntParam(soplex::SoPlex::SOLVEMODE, soplex::SoPlex::SOLVEMODE_RATIONAL);
+    sop.setIntParam(soplex::SoPlex::CHECKMODE, soplex::SoPlex::CHECKMODE_RATIONAL);
+    sop.setIntParam(soplex::SoPlex::SYNCMODE, soplex::SoPlex::SYNCMODE_AUTO);
+    sop.setRealParam(soplex::SoPlex::FEASTOL, 0.0);
+    sop.setRealParam(soplex::SoPlex::OPTTOL, 0.0);
+    sop.setIntParam(soplex::SoPlex::VERBOSITY, soplex::SoPlex::VERBOSITY_ERROR);
+    sop.setIntParam(soplex::SoPlex::OBJSENSE, soplex::SoPlex::OBJSENSE_MAXIMIZE);
+
+    soplex::DSVectorRational dummycol(0);
+    for ( unsigned i = 1; i <= dim; i++ )
+        sop.addColRational(soplex::LPColRational(objFunc.at(i), dummycol, soplex::Rational(1), soplex::Rational(0)));
+
+    for ( size_t i = 0; i < boundaryData.size(); i++ )
+    {
+        const BoundaryPrototype& boundProt = boundaryPrototypeData->at(boundaryData.at(i).first);
+
+        soplex::DSVectorRational row(dim);
+        for ( size_t j = 1; j <= dim; j++ )
+            row.add(j-1, soplex::Rational(boundProt.at(j)));
+
+        if ( boundaryData.at(i).second == GeqZero )
+            sop.addRowRational(soplex::LPRowRational(-soplex::Rational(boundProt.at(0)), row, soplex::Rational(soplex::infinity)));
+        else if ( boundaryData.at(i).second == LeqZero )
+            sop.addRowRational(soplex::LPRowRational(-soplex::Rational(soplex::infinity), row, -soplex::Rational(boundProt.at(0))));
+    }
+
+    soplex::SPxSolver::Status status = sop.optimize();
+
+    // An empty region puts any piece both above and below
+    if ( status == soplex::SPxSolver::INFEASIBLE )
+        return true;
+    else if ( status != soplex::SPxSolver::OPTIMAL )
+        throw std::runtime_error("Rational LP unable to compare linear pieces.");
+
+    return ( sop.objValueRational() + objFunc.at(0) <= soplex::Rational(0) );
+}
+
+bool RegionalLinearPiece::position(Position pos, const RegionalLinearPiece& comparedRlp)
+{
+    std::unique_ptr<soplex::SoPlex> sop;
+
+    return position(sop, pos, comparedRlp);
+}
+
+// Positions of every compared piece relative to this one on this region,
+// solving all the comparisons on one LP
+void RegionalLinearPiece::comparedPositions(const std::vector<RegionalLinearPiece>& comparedRlps,
+                                            std::vector<char>& comparedAbove,
+                                            std::vector<char>& comparedBelow)
+{
+    std::unique_ptr<soplex::SoPlex> sop;
+
+    comparedAbove.resize(comparedRlps.size());
+    comparedBelow.resize(comparedRlps.size());
+
+    for ( size_t k = 0; k < comparedRlps.size(); k++ )
+    {
+        comparedAbove.at(k) = position(sop, ComparedIsAbove, comparedRlps.at(k));
+        comparedBelow.at(k) = position(sop, ComparedIsBelow, comparedRlps.at(k));
+    }
+}
+
 bool RegionalLinearPiece::comparedIsAbove(const RegionalLinearPiece& comparedRlp)
 {
     return position(ComparedIsAbove, comparedRlp);
@@ -11,6 +11,7 @@ class TestMode(Enum):
     LIMODSAT = 3
     countPWLvarLayers = 4
     countPWLvarNodes = 5
+    CONFLICTS = 6
 
 PRECISION = 5
 DECPRECISION_form = ".5f"
@@ -21,6 +22,7 @@ yices_path = "yices-smt2"
 import torch
 import torch.onnx
 import csv
+import json
 import os
 import sys
 import subprocess
@@ -295,6 +297,20 @@ def createSmt(fileName, smtFileName, dimension, values):
 
     smtFile.close()
 
+# the SMT-LIB2 file written by reluka, with the input variables fixed to the given values
+def instantiateSmt(fileName, smtFileName, values):
+    out_file = open(data_folder+fileName, "r")
+    smt = out_file.read()
+    out_file.close()
+
+    inputs = ""
+    for val in range(len(values)):
+        inputs += "(assert (= X"+str(val+1)+" "+format(values[val], DECPRECISION_form)+"))"+"\n"
+
+    smtFile = open(data_folder+smtFileName, "w")
+    smtFile.write(smt.replace("(check-sat)", inputs+"\n(check-sat)"))
+    smtFile.close()
+
 def evaluateSmt(smtFileName):
     smtOut = subprocess.check_output([yices_path, data_folder+smtFileName]).decode(sys.stdout.encoding)
 
@@ -320,13 +336,15 @@ def runLimodsatTest(fileName, torchModel, inputDim):
             x.append(random.uniform(0,1))
     
         createSmt(fileName+"_0.limodsat", fileName+"_"+str(i)+".smt", inputDim, x)
+        instantiateSmt(fileName+"_0.smt2", fileName+"_"+str(i)+"_native.smt", x)
         torchValue = torchModel(torch.as_tensor(x).float())
         modsatValue = evaluateSmt(fileName+"_"+str(i)+".smt")
-        os.system("rm "+data_folder+fileName+"_"+str(i)+".smt")
+        smt2Value = evaluateSmt(fileName+"_"+str(i)+"_native.smt")
+        os.system("rm "+data_folder+fileName+"_"+str(i)+".smt "+data_folder+fileName+"_"+str(i)+"_native.smt")
 
         singleResult = "{:3d}".format(i+1) + " | "
 
-        if abs(torchValue.item() - modsatValue) < 10**-PRECISION:
+        if ( abs(torchValue.item() - modsatValue) < 10**-PRECISION ) and ( abs(torchValue.item() - smt2Value) < 10**-PRECISION ):
             singleResult += "SUCCESS :-D | "
             statistics[0] += 1
         else:
@@ -335,7 +353,7 @@ def runLimodsatTest(fileName, torchModel, inputDim):
 
         for j in range(inputDim):
             singleResult += "x" + str(j+1) + ": {:.{}f}".format(x[j], PRECISION) + " | "
-        singleResult += "| limodsat: " + "{:.{}f}".format(modsatValue, PRECISION) + " | torch: " + "{:.{}f}".format(torchValue.item(), PRECISION)
+        singleResult += "| limodsat: " + "{:.{}f}".format(modsatValue, PRECISION) + " | smt2: " + "{:.{}f}".format(smt2Value, PRECISION) + " | torch: " + "{:.{}f}".format(torchValue.item(), PRECISION)
 
         results.append(singleResult)
 
@@ -367,7 +385,7 @@ def runRandomLimodsatTest(fileName, inputDim, hiddenDim, hiddenNum):
     toOnnxInput = torch.as_tensor([0]*inputDim).float()
     torch.onnx.export(torchModel, toOnnxInput, data_folder+fileName+".onnx")
 
-    os.system(reluka_path+" -onnx "+data_folder+fileName+".onnx -limodsat")
+    os.system(reluka_path+" -onnx "+data_folder+fileName+".onnx -limodsat -smt2")
 
     runLimodsatTest(fileName, torchModel, inputDim)
 
@@ -436,6 +454,38 @@ def runRandomMultiPwlTest(fileName, inputDim, hiddenDim, hiddenNum, outputDim):
         pwlData = pwlFileParser(fileName+"_"+str(outputNum)+".pwl")
         runPwlTest(fileName+"_"+str(outputNum), torchModel, pwlData, outputNum)
 
+def runConflictTest(fileName, inputDim, hiddenDim, hiddenNum):
+    global summary
+
+    torchModel = RandPwlNeuralNet(inputDim, hiddenDim, hiddenNum)
+    torch.save(torchModel, data_folder+fileName+".torch")
+
+    toOnnxInput = torch.as_tensor([0]*inputDim).float()
+    torch.onnx.export(torchModel, toOnnxInput, data_folder+fileName+".onnx")
+    os.system(reluka_path+" -onnx "+data_folder+fileName+".onnx -pwl -stats -conflicts "+str(CONFLICT_STORE_SIZE))
+
+    with open(data_folder+fileName+"_stats.json", "r") as statsFile:
+        stats = json.load(statsFile)
+
+    regionsNum = stats["total"]["layers"][-1]["regions"]
+    learnedNum = max(sum(layer["conflictsLearned"] for layer in worker["layers"]) for worker in stats["workers"])
+
+    # A worker learning more conflicts than its store holds shows that those
+    # of finished layers were dropped to make room
+    message = fileName + ": " + str(regionsNum) + " regions, " + str(learnedNum) + " conflicts learned by one worker, store of " + str(CONFLICT_STORE_SIZE) + ": "
+    if regionsNum <= CONFLICT_STORE_SIZE:
+        message += "too few regions to fill the store"
+    elif learnedNum <= CONFLICT_STORE_SIZE:
+        message += "FAILED, conflicts stopped being learned :("
+    else:
+        message += "PASSED ALL EVALUATIONS!!!"
+
+    print(message)
+    summary.append(message)
+
+    pwlData = pwlFileParser(fileName+"_0.pwl")
+    runPwlTest(fileName, torchModel, pwlData, 0)
+
 def createSummary():
     global summary
 
@@ -502,6 +552,10 @@ MAX_LAYERS = 3
 # for countPWL
 NUM_FIX_NODES = 2
 NUM_FIX_LAYERS = 2
+
+# for CONFLICTS
+NUM_CONFLICT_NODES = 12
+CONFLICT_STORE_SIZE = 2
 ######################################
 
 summary = []
@@ -618,6 +672,24 @@ elif TEST_MODE is TestMode.countPWLvarNodes:
         summary_writer.writerow(sum)
     summary_file.close()
 
+#
+# For each configuration of neural network with MAX_INPUTS inputs, one output, NUM_CONFLICT_NODES nodes in each layer of {1,...,MAX_LAYERS} layers,
+# enumerate the regions of SINGLE_CONFIG_TEST_NUM neural networks with a conflict store of CONFLICT_STORE_SIZE and check that more conflicts than it holds
+# are learned, then compare the evaluation of the neural network to the evaluation of its .pwl representation, for SINGLE_NN_TEST_NUM random tests.
+#
+elif TEST_MODE is TestMode.CONFLICTS:
+    data_folder = "./conflictsTestData/"
+    setDataFolder()
+
+    for layersNum in range(MAX_LAYERS):
+        for config in range(SINGLE_CONFIG_TEST_NUM):
+            runConflictTest("test_"+str(MAX_INPUTS)+"_"+str(NUM_CONFLICT_NODES)+"_"+str(layersNum+1)+"_n"+str(config+1),
+                            MAX_INPUTS,
+                            NUM_CONFLICT_NODES,
+                            layersNum+1)
+
+    createSummary()
+
 #
 # Something else.
 #